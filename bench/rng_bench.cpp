@@ -0,0 +1,77 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : rng_bench.cpp
+ * Micro-benchmark comparant les tirages aléatoires de la simulation : l'ancienne version
+ * (std::mt19937_64 et une std::uniform_int_distribution construite à chaque appel, avec
+ * rejet pour randomSiteExcept) et la version actuelle basée sur FastRng.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "config.h"
+
+namespace {
+
+const unsigned long long NB_DRAWS = 50'000'000;
+
+// Anciennes versions, reprises telles quelles pour la comparaison
+thread_local std::mt19937_64 legacyRng(std::random_device{}());
+
+unsigned int legacyRandomSiteExcept(unsigned int maxSite, unsigned int exclude)
+{
+    std::uniform_int_distribution<unsigned int> dist(0, maxSite - 1);
+    unsigned int s;
+    do {
+        s = dist(legacyRng);
+    } while (s == exclude);
+    return s;
+}
+
+unsigned int legacyRandomTravelTimeMs()
+{
+    std::uniform_int_distribution<unsigned int> dist(500, 2000);
+    return dist(legacyRng);
+}
+
+template<typename F>
+void run(const char* name, F draw)
+{
+    unsigned long long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < NB_DRAWS; ++i) {
+        sink += draw(static_cast<unsigned int>(i));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // sink affiché pour que le compilateur ne supprime pas la boucle
+    std::printf("%-32s %8.1f Mdraws/s  (checksum %llu)\n",
+                name, NB_DRAWS / elapsed.count() / 1e6, sink);
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("%llu draws per case, sizeof(mt19937_64) = %zu, sizeof(FastRng) = %zu\n\n",
+                NB_DRAWS, sizeof(std::mt19937_64), sizeof(FastRng));
+
+    run("legacy randomSiteExcept", [](unsigned int i) {
+        return legacyRandomSiteExcept(NBSITES, i % NBSITES);
+    });
+    run("randomSiteExcept", [](unsigned int i) {
+        return randomSiteExcept(NBSITES, i % NBSITES);
+    });
+    run("legacy randomTravelTimeMs", [](unsigned int) {
+        return legacyRandomTravelTimeMs();
+    });
+    run("randomTravelTimeMs", [](unsigned int) {
+        return randomTravelTimeMs();
+    });
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : station_wait_bench.cpp
+ * Benchmark des politiques d'attente des stations : des personnes se disputent moins de vélos
+ * qu'elles ne sont, chacune loue un vélo, le garde un moment puis le rend. Pour chaque politique
+ * (endormissement immédiat, attente adaptative, boucle active longue) et chaque durée de
+ * location, on mesure la latence des locations et le temps CPU consommé par seconde.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "bikestation.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t NB_RIDERS = 4;
+const size_t NB_STATION_BIKES = 2;
+const size_t STATION_CAPACITY = 4;
+const std::chrono::milliseconds RUN_TIME(1000);
+
+struct Case
+{
+    const char* name;
+    WaitPolicy policy;
+};
+
+double cpuSeconds()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+         + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Location : attente active pour les durées courtes (sleep_for serait bien plus long)
+void ride(std::chrono::nanoseconds _duration)
+{
+    if (_duration >= std::chrono::microseconds(100)) {
+        std::this_thread::sleep_for(_duration);
+        return;
+    }
+    Clock::time_point end = Clock::now() + _duration;
+    while (Clock::now() < end) {
+    }
+}
+
+void run(const Case& _case, std::chrono::nanoseconds _rideTime)
+{
+    BikeStation station(STATION_CAPACITY, _case.policy);
+    std::vector<Bike> bikes(NB_STATION_BIKES);
+    std::vector<Bike*> toAdd;
+    for (Bike& bike : bikes) {
+        bike.bikeType = 0;
+        toAdd.push_back(&bike);
+    }
+    station.addBikes(toAdd);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<std::uint64_t>> latencies(NB_RIDERS);
+    std::vector<std::thread> riders;
+
+    double cpuBefore = cpuSeconds();
+    Clock::time_point start = Clock::now();
+
+    for (size_t r = 0; r < NB_RIDERS; ++r) {
+        riders.emplace_back([&, r] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                Clock::time_point before = Clock::now();
+                Bike* bike = station.getBike(0);
+                if (!bike)
+                    return;
+                latencies[r].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                           Clock::now() - before).count());
+                ride(_rideTime);
+                station.putBike(bike);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(RUN_TIME);
+    stop = true;
+    station.ending();
+    for (std::thread& rider : riders)
+        rider.join();
+
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    double cpu = cpuSeconds() - cpuBefore;
+
+    std::vector<std::uint64_t> all;
+    for (const auto& samples : latencies)
+        all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+
+    double mean = 0;
+    for (std::uint64_t latency : all)
+        mean += latency;
+    mean = all.empty() ? 0 : mean / all.size();
+    std::uint64_t p99 = all.empty() ? 0 : all[all.size() * 99 / 100];
+
+    std::printf("%-10s %10lld %12.0f %10.1f %10.1f %12.2f\n",
+                _case.name, static_cast<long long>(_rideTime.count()),
+                all.size() / wall, mean / 1e3, p99 / 1e3, cpu / wall);
+}
+
+} // namespace
+
+int main()
+{
+    const Case cases[] = {
+        {"park", WaitPolicy{0, 0}},
+        {"site", SITE_WAIT_POLICY},
+        {"adaptive", WaitPolicy{2'000, 500'000}},
+        {"spin", WaitPolicy{500'000, 500'000}},
+    };
+    const std::chrono::nanoseconds rideTimes[] = {
+        std::chrono::microseconds(1),
+        std::chrono::microseconds(20),
+        std::chrono::milliseconds(1),
+    };
+
+    std::printf("%zu riders, %zu bikes, %zu docks, %lld ms per case, %u hardware threads\n\n",
+                NB_RIDERS, NB_STATION_BIKES, STATION_CAPACITY,
+                static_cast<long long>(RUN_TIME.count()), std::thread::hardware_concurrency());
+    std::printf("%-10s %10s %12s %10s %10s %12s\n",
+                "policy", "ride(ns)", "rentals/s", "mean(us)", "p99(us)", "cpu/wall");
+
+    for (std::chrono::nanoseconds rideTime : rideTimes)
+        for (const Case& c : cases)
+            run(c, rideTime);
+
+    return 0;
+}
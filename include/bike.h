@@ -2,16 +2,29 @@
 #define BIKE_H
 
 #include <cstdlib>
+#include "config.h"
 
 /**
  * @brief Represents a bike with a given type.
  *
- * A bike is characterized only by its type. The type is encoded as an index
- * in the range [0, nbBikeTypes).
+ * A bike is characterized by its type, encoded as an index in the range
+ * [0, nbBikeTypes), and by its usage history (rides, ride time, maintenance).
+ *
+ * The usage counters are only written by the agent holding the bike (a
+ * person, the van) while it is present at a quiescent point of the
+ * checkpoint barrier, never between Checkpoint::leave() and
+ * Checkpoint::arrive(). A station only reads them. A checkpoint reads them
+ * once every agent is away, parked or finished, so they need no
+ * synchronization of their own.
  */
 class Bike
 {
 public:
+    /**
+     * @brief Unique identifier of this bike (used by checkpoints).
+     */
+    unsigned int id = 0;
+
     /**
      * @brief Type of this bike.
      *
@@ -19,6 +32,54 @@ public:
      */
     size_t bikeType;
 
+    /**
+     * @brief Total number of rides done with this bike (odometer).
+     */
+    size_t nbRides = 0;
+
+    /**
+     * @brief Total riding time accumulated by this bike, in milliseconds.
+     */
+    unsigned long long totalRideTimeMs = 0;
+
+    /**
+     * @brief Number of rides since the last maintenance.
+     */
+    size_t ridesSinceService = 0;
+
+    /**
+     * @brief Indicates that the bike must be brought back to the depot.
+     */
+    bool needsMaintenance = false;
+
+    /**
+     * @brief Records a ride done with this bike.
+     *
+     * Flags the bike for maintenance once @ref MAINTENANCE_RIDES rides have
+     * been done since the last service.
+     *
+     * @param _ms Duration of the ride in milliseconds.
+     */
+    void recordRide(unsigned int _ms)
+    {
+        ++nbRides;
+        ++ridesSinceService;
+        totalRideTimeMs += _ms;
+        if (ridesSinceService >= MAINTENANCE_RIDES)
+            needsMaintenance = true;
+    }
+
+    /**
+     * @brief Services the bike at the depot and clears the maintenance flag.
+     *
+     * The odometer (@ref nbRides, @ref totalRideTimeMs) is kept.
+     */
+    void service()
+    {
+        ridesSinceService = 0;
+        needsMaintenance = false;
+    }
+
     /**
      * @brief Total number of supported bike types.
      *
@@ -8,6 +8,13 @@
  * Elle utilise un mutex et des variables de condition (slots_available et bikes_of_type_available)
  * pour la synchronisation des accès aux ressources partagées (dépôt et retrait de vélos) par différentes entités
  * (utilisateurs, van de maintenance).
+ * Les vélos disponibles sont rangés dans une file sans verrou par type, et les bornes libres comptées par un
+ * compteur atomique : un retrait ou un dépôt sans attente se fait sans prendre le mutex. Le moniteur ne sert
+ * que lorsqu'il faut attendre (type vide, station pleine) et pour les opérations composées (van, réservations).
+ * Avant de s'endormir dans le moniteur, un thread peut tourner brièvement selon la WaitPolicy de la station.
+ * Le nombre de personnes bloquées est borné par les AdmissionLimits : au-delà, la demande est refusée tout de suite.
+ * Chaque mutation est ajoutée au journal de la station (StationLog), d'où sont tirées les intégrales
+ * d'utilisation et les états passés, et reportée dans l'index global du déséquilibre (ImbalanceIndex).
  */
 
 #ifndef BIKESTATION_H
@@ -16,11 +23,152 @@
 #include <vector>
 #include <deque>
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
 #include "bike.h"
+#include "boundedqueue.h"
+#include "imbalanceindex.h"
+#include "timerwheel.h"
+#include "lockprofiler.h"
+#include "stationlog.h"
+#include "vancargo.h"
+#include "waitpolicy.h"
 
 #include <pcosynchro/pcomutex.h>
 #include <pcosynchro/pcoconditionvariable.h>
 
+/**
+ * @brief Parameters of one van stop, evaluated by BikeStation::rebalance().
+ */
+struct RebalancePlan
+{
+    /**
+     * @brief Number of bikes the site should hold after the stop.
+     */
+    size_t target;
+
+    /**
+     * @brief Maximum number of bikes the van can carry.
+     */
+    size_t cargoCapacity;
+};
+
+/**
+ * @brief State of a station right after a rebalancing operation.
+ */
+struct StationState
+{
+    /**
+     * @brief Total number of bikes in the station (flagged ones included).
+     */
+    size_t nbBikes = 0;
+
+    /**
+     * @brief Number of bikes available to riders, per type.
+     */
+    std::array<size_t, Bike::nbBikeTypes> bikesOfType{};
+
+    /**
+     * @brief Number of bikes waiting for maintenance.
+     */
+    size_t nbForMaintenance = 0;
+
+    /**
+     * @brief Number of bikes moved from the station to the van.
+     */
+    size_t taken = 0;
+
+    /**
+     * @brief Number of bikes moved from the van to the station.
+     */
+    size_t dropped = 0;
+};
+
+/**
+ * @brief Admission limits of a station.
+ *
+ * Only apply to the callers of getBike()/putBike() that ask for admission
+ * control; by default a station admits every waiter.
+ */
+struct AdmissionLimits
+{
+    /**
+     * @brief Maximum number of riders blocked waiting for a bike, per type.
+     */
+    size_t maxWaitingRiders = SIZE_MAX;
+
+    /**
+     * @brief Maximum number of riders blocked waiting for a dock.
+     */
+    size_t maxWaitingDepositors = SIZE_MAX;
+};
+
+/**
+ * @brief Consistent view of the bike counts of a station.
+ *
+ * Obtained through BikeStation::snapshot() without taking the station lock.
+ */
+struct StationCounts
+{
+    /**
+     * @brief Total number of bikes in the station (flagged ones included).
+     */
+    size_t nbBikes = 0;
+
+    /**
+     * @brief Number of bikes available to riders, per type.
+     */
+    std::array<size_t, Bike::nbBikeTypes> bikesOfType{};
+
+    /**
+     * @brief Number of bikes waiting for maintenance.
+     */
+    size_t nbForMaintenance = 0;
+
+    /**
+     * @brief Number of bikes held for a reservation (counted in nbBikes).
+     */
+    size_t nbReservedBikes = 0;
+
+    /**
+     * @brief Number of free docks held for a reservation.
+     */
+    size_t nbReservedDocks = 0;
+
+    /**
+     * @brief Number of threads blocked waiting for a bike, per type (live, not
+     *        covered by the sequence lock).
+     */
+    std::array<size_t, Bike::nbBikeTypes> nbWaitingRiders{};
+
+    /**
+     * @brief Number of threads blocked waiting for a dock (live).
+     */
+    size_t nbWaitingDepositors = 0;
+
+    /**
+     * @brief Number of requests refused by admission control since the start (live).
+     */
+    unsigned long long nbOverloaded = 0;
+};
+
+/**
+ * @brief Handle on a bike or dock reservation made at a station.
+ */
+struct Reservation
+{
+    /**
+     * @brief Identifier of the reservation, 0 if none was obtained.
+     */
+    unsigned long long id = 0;
+
+    /**
+     * @brief Indicates whether the reservation was granted.
+     */
+    bool valid() const { return id != 0; }
+};
+
 /**
  * @brief Thread-safe bike station storing bikes by type with a limited capacity.
  *
@@ -41,13 +189,19 @@ public:
      * @brief Constructs a bike station with the given capacity.
      *
      * @param _capacity Maximum number of bikes that can be stored at this station.
+     * @param _waitPolicy Spin-then-park policy of the blocking getBike()/putBike().
+     * @param _admission Limits on the number of blocked riders and depositors.
      */
-    BikeStation(int _capacity);
+    BikeStation(int _capacity, const WaitPolicy& _waitPolicy = WaitPolicy{},
+                const AdmissionLimits& _admission = AdmissionLimits{});
 
     /**
      * @brief Destructor.
      *
-     * Calls ending() to wake up all waiting threads and signal termination.
+     * Calls ending() to wake up all waiting threads and signal termination,
+     * then cancels the expiry timers of the active reservations, which point
+     * to the station. Waits for the timers that have already fired to run
+     * their handler, so none can run once the station is destroyed.
      */
     ~BikeStation();
 
@@ -55,22 +209,33 @@ public:
      * @brief Inserts a bike into the station.
      *
      * If the station is full, the calling thread blocks until a slot becomes
-     * available or the station is marked as ending.
+     * available or the station is marked as ending. When a slot is free and
+     * the bike is not flagged for maintenance, the station mutex is not taken.
+     * Before blocking, the thread spins as allowed by the wait policy.
      *
      * @param _bike Pointer to the bike to put into the station. Must not be null.
+     * @param _overloaded If given, admission control applies: when as many
+     *        depositors as allowed are already blocked, returns at once
+     *        without storing the bike and sets *_overloaded to true.
      */
-    void putBike(Bike *_bike); // Pour une personne
+    void putBike(Bike *_bike, bool* _overloaded = nullptr); // Pour une personne
 
     /**
      * @brief Retrieves one bike of the requested type from the station.
      *
      * If no bike of the requested type is available, the calling thread waits
-     * until one is put or until the station is ending.
+     * until one is put or until the station is ending. When a bike is
+     * available, the station mutex is not taken. Before blocking, the thread
+     * spins as allowed by the wait policy.
      *
      * @param _bikeType Requested bike type index (0..Bike::nbBikeTypes-1).
-     * @return Pointer to the retrieved bike, or nullptr if the station is ending.
+     * @param _overloaded If given, admission control applies: when as many
+     *        riders as allowed are already blocked for this type, returns
+     *        nullptr at once and sets *_overloaded to true.
+     * @return Pointer to the retrieved bike, or nullptr if the station is
+     *         ending or overloaded.
      */
-    Bike* getBike(size_t _bikeType); // Pour une personne
+    Bike* getBike(size_t _bikeType, bool* _overloaded = nullptr); // Pour une personne
 
     /**
      * @brief Adds several bikes to the station at once.
@@ -83,6 +248,17 @@ public:
      */
     std::vector<Bike*> addBikes(std::vector<Bike*> _bikesToAdd); // Pour le van
 
+    /**
+     * @brief Adds several bikes to the station at once, without allocating.
+     *
+     * Bikes are inserted in order while slots remain: the bikes that do not
+     * fit are the last ones of @p _bikesToAdd.
+     *
+     * @param _bikesToAdd Bikes to insert.
+     * @return Number of bikes inserted (a prefix of @p _bikesToAdd).
+     */
+    size_t addBikes(std::span<Bike* const> _bikesToAdd); // Pour le van
+
     /**
      * @brief Retrieves up to a given number of bikes from the station.
      *
@@ -94,6 +270,146 @@ public:
      */
     std::vector<Bike*> getBikes(size_t _nbBikes); // Pour le van
 
+    /**
+     * @brief Retrieves bikes into a caller-provided buffer, without allocating.
+     *
+     * Same order as getBikes(size_t), at most @p _out.size() bikes.
+     *
+     * @param _out Buffer receiving the bikes.
+     * @return Number of bikes written at the start of @p _out.
+     */
+    size_t getBikes(std::span<Bike*> _out); // Pour le van
+
+    /**
+     * @brief Retrieves up to a given number of bikes flagged for maintenance.
+     *
+     * Flagged bikes occupy a slot but are never handed to riders; only the
+     * van collects them to bring them back to the depot.
+     *
+     * @param _nbBikes Maximum number of bikes to retrieve.
+     * @return Vector containing the flagged bikes retrieved (may be empty).
+     */
+    std::vector<Bike*> getBikesForMaintenance(size_t _nbBikes); // Pour le van
+
+    /**
+     * @brief Retrieves flagged bikes into a caller-provided buffer, without allocating.
+     *
+     * @param _out Buffer receiving the bikes.
+     * @return Number of bikes written at the start of @p _out.
+     */
+    size_t getBikesForMaintenance(std::span<Bike*> _out); // Pour le van
+
+    /**
+     * @brief Performs a whole van stop under a single lock acquisition.
+     *
+     * In order: collects the bikes flagged for maintenance, takes the surplus
+     * above @p _plan.target, then drops bikes from @p _cargo to fill the
+     * deficit, missing types first, then the types the station has least of.
+     * Bikes flagged for maintenance are never dropped. Waiting riders are
+     * woken once per type that received bikes, and waiting depositors once
+     * if slots were freed.
+     *
+     * @param _plan Target and van capacity for this stop.
+     * @param _cargo Van cargo, updated in place.
+     * @return State of the station after the stop.
+     */
+    StationState rebalance(const RebalancePlan& _plan, VanCargo& _cargo); // Pour le van
+
+    /**
+     * @brief Reserves a bike of a given type for a limited time.
+     *
+     * The bike is set aside at once: it still occupies its dock but no other
+     * rider can take it. If the reservation is not honoured by
+     * takeReservedBike() within @p _ttlMs, it expires and the bike becomes
+     * available again.
+     *
+     * @param _bikeType Requested bike type index (0..Bike::nbBikeTypes-1).
+     * @param _ttlMs Lifetime of the reservation in milliseconds.
+     * @return Granted reservation, or an invalid one if no bike of this type
+     *         is available.
+     */
+    Reservation reserveBike(size_t _bikeType, unsigned int _ttlMs); // Pour une personne
+
+    /**
+     * @brief Reserves a free dock for a limited time.
+     *
+     * The dock is no longer offered to other depositors until the
+     * reservation is honoured by putReservedBike() or expires.
+     *
+     * @param _ttlMs Lifetime of the reservation in milliseconds.
+     * @return Granted reservation, or an invalid one if no dock is free.
+     */
+    Reservation reserveDock(unsigned int _ttlMs); // Pour une personne
+
+    /**
+     * @brief Takes the bike held by a reservation.
+     *
+     * If the reservation is invalid or has expired, behaves like getBike().
+     *
+     * @param _reservation Reservation returned by reserveBike().
+     * @param _bikeType Bike type index used if the reservation has expired.
+     * @param _overloaded Admission control of the getBike() fallback.
+     * @return Pointer to the bike, or nullptr if the station is ending or overloaded.
+     */
+    Bike* takeReservedBike(const Reservation& _reservation, size_t _bikeType,
+                           bool* _overloaded = nullptr); // Pour une personne
+
+    /**
+     * @brief Puts a bike in the dock held by a reservation.
+     *
+     * Never blocks while the reservation is active. If it is invalid or has
+     * expired, behaves like putBike().
+     *
+     * @param _bike Pointer to the bike to put into the station. Must not be null.
+     * @param _reservation Reservation returned by reserveDock().
+     * @param _overloaded Admission control of the putBike() fallback.
+     */
+    void putReservedBike(Bike* _bike, const Reservation& _reservation,
+                         bool* _overloaded = nullptr); // Pour une personne
+
+    /**
+     * @brief Returns a consistent view of the station counts.
+     *
+     * Every mutation made under the station mutex runs inside a sequence
+     * lock, from its first counter change to the publication of its counts:
+     * readers never take the station mutex, so they never block
+     * getBike()/putBike(), and retry if such a mutation ran while they were
+     * reading. The per-type counts are the live counters of the lock-free
+     * path: a rental or return that did not wait (or a rental woken under
+     * the mutex) changes a single count outside the sequence and may still
+     * straddle the read; the view then holds that one change or not.
+     *
+     * @return Counts of the station at some point in time.
+     */
+    StationCounts snapshot() const;
+
+    /**
+     * @brief Returns the utilisation integrals of the station up to now.
+     *
+     * Computed incrementally from the station log (bike-ms docked and
+     * dock-ms without a bike), without polling the counts.
+     */
+    StationLog::Utilisation utilisation();
+
+    /**
+     * @brief Reconstructs the counts of the station at a past simulated time.
+     *
+     * @param _timeMs Simulated time in milliseconds.
+     * @return Counts at that time; see StationLog::State::exact.
+     */
+    StationLog::State stateAt(unsigned long long _timeMs);
+
+    /**
+     * @brief Reports every later change of the stock of the station to a global index.
+     *
+     * Must be called before the station is shared; the current stock is
+     * published at once.
+     *
+     * @param _index Imbalance index of the network.
+     * @param _site Index of the station in @p _index.
+     */
+    void trackImbalance(ImbalanceIndex* _index, unsigned int _site);
+
     /**
      * @brief Counts the bikes of a specific type currently stored.
      *
@@ -102,12 +418,21 @@ public:
      */
     size_t countBikesOfType(size_t type) const;
 
+    /**
+     * @brief Counts the bikes waiting for maintenance at this station.
+     *
+     * @return Number of flagged bikes stored in the station.
+     */
+    size_t countBikesForMaintenance() const;
+
     /**
      * @brief Returns the total number of bikes currently stored.
      *
+     * Lock-free, see snapshot().
+     *
      * @return Current number of bikes in the station.
      */
-    size_t nbBikes();
+    size_t nbBikes() const;
 
     /**
      * @brief Returns the maximum number of bikes the station can contain.
@@ -116,6 +441,39 @@ public:
      */
     size_t nbSlots();
 
+    /**
+     * @brief Returns the number of free docks, reserved ones excluded.
+     *
+     * Lock-free; only exact while the station is frozen or idle.
+     *
+     * @return Docks neither occupied by a bike nor held by a reservation.
+     */
+    size_t nbFreeSlots() const;
+
+    /**
+     * @brief Locks the station so that its content can be read by dockedBikes().
+     *
+     * Also closes the lock-free path and waits for the operations in progress
+     * on it: they fall back to the monitor until thaw().
+     *
+     * Used by checkpoints to take a consistent cut of several stations.
+     */
+    void freeze();
+
+    /**
+     * @brief Unlocks a station locked by freeze().
+     */
+    void thaw();
+
+    /**
+     * @brief Lists every bike occupying a dock; the station must be frozen.
+     *
+     * Bikes held by reservations are included, reservations themselves are not.
+     *
+     * @return Bikes available to riders, waiting for maintenance or reserved.
+     */
+    std::vector<Bike*> dockedBikes() const;
+
     /**
      * @brief Signals that the station is ending and wakes up all waiting threads.
      *
@@ -125,25 +483,230 @@ public:
     void ending();
 
 private:
+    /**
+     * @brief Counts the bikes in storage; the mutex must be held.
+     *
+     * Bikes waiting for maintenance and bikes held by reservations are
+     * included since they occupy a dock.
+     */
+    size_t storedBikes() const;
+
+    /**
+     * @brief Decrements a counter if it is positive.
+     *
+     * Used to claim a bike of a type or a free dock before touching the
+     * storage, by the lock-free path and the monitor alike.
+     *
+     * @return true if a unit was claimed.
+     */
+    static bool claim(std::atomic<long>& _counter);
+
+    /**
+     * @brief Takes a bike of a type already claimed in available.
+     */
+    Bike* popClaimed(size_t _bikeType);
+
+    /**
+     * @brief Stores a rideable bike in a dock already claimed and makes it available.
+     */
+    void pushAvailable(Bike* _bike);
+
+    /**
+     * @brief Stores a bike in a dock already claimed; the mutex must be held.
+     *
+     * The deposit must already be logged: once stored, the bike can be taken
+     * (and its removal logged) by another thread.
+     */
+    void storeBike(Bike* _bike);
+
+    /**
+     * @brief Log counter of a bike being stored (its type, or the maintenance counter).
+     */
+    static unsigned int logCounter(const Bike* _bike);
+
+    /**
+     * @brief Gives a dock back to the free slots.
+     */
+    void releaseSlots(size_t _count);
+
+    /**
+     * @brief Takes a bike of a type through the lock-free path.
+     *
+     * @return The bike, or nullptr if none is available or the path is closed.
+     */
+    Bike* tryGetFast(size_t _bikeType);
+
+    /**
+     * @brief Stores a rideable bike through the lock-free path.
+     *
+     * @return false if no dock is free or the path is closed.
+     */
+    bool tryPutFast(Bike* _bike);
+
+    /**
+     * @brief Enters the lock-free path.
+     *
+     * @return false if it is closed (station frozen or ending); the caller
+     *         must then use the monitor.
+     */
+    bool enterFastPath();
+
+    /**
+     * @brief Leaves the lock-free path entered by enterFastPath().
+     */
+    void leaveFastPath();
+
+    /**
+     * @brief Releases a reservation that was not honoured in time.
+     *
+     * Called by the timer wheel through onReservationExpired().
+     *
+     * @param _id Identifier of the expired reservation.
+     */
+    void expireReservation(unsigned long long _id);
+
+    /**
+     * @brief Timer wheel handler forwarding to expireReservation().
+     */
+    static void onReservationExpired(void* _station, unsigned long long _id);
+
+    /**
+     * @brief Reservation en cours : vélo mis de côté, ou borne si bike est nul.
+     */
+    struct ReservationEntry
+    {
+        unsigned long long id;
+        Bike* bike;
+        TimerWheel::TimerId timer;
+    };
+
+    /**
+     * @brief Removes an active reservation; the mutex must be held.
+     *
+     * @param _id Identifier of the reservation.
+     * @param _entry Filled with the removed entry.
+     * @return true if the reservation was still active.
+     */
+    bool removeReservation(unsigned long long _id, ReservationEntry& _entry);
+
+    /**
+     * @brief Opens a mutation for snapshot() readers (odd sequence); the mutex must be held.
+     *
+     * Called before the first counter changed under the mutex, so that the
+     * per-type counts changed by the mutation are covered by the sequence.
+     */
+    void beginPublish();
+
+    /**
+     * @brief Publishes the counts and closes the mutation (even sequence); the mutex must be held.
+     */
+    void endPublish();
+
+    /**
+     * @brief Records a mutation in the station log and in the imbalance index.
+     *
+     * Called after the resource consumed is claimed and before the resource
+     * produced is published (bike made available, dock released), so that
+     * the log orders every deposit before the removal of the same bike, and
+     * every removal before the deposit in the dock it freed.
+     */
+    void record(StationLog::Kind _kind, unsigned int _counter, long _delta);
+
     /**
      * @brief Maximum number of bikes that can be stored in this station.
      */
     const size_t capacity;
 
     /**
-     * @brief Stockage des vélos par type, utilisant une deque pour du FIFO pour chaque type.
+     * @brief Stockage des vélos par type, une file FIFO sans verrou pour chaque type.
+     */
+    std::array<BoundedQueue<Bike*>, Bike::nbBikeTypes> storage;
+
+    /**
+     * @brief Vélos de chaque type pouvant être réclamés (par claim()) puis retirés de storage.
+     *
+     * Incrémenté après l'insertion dans la file : un vélo compté y est toujours, ou va y être
+     * visible dans l'instant.
+     */
+    std::array<std::atomic<long>, Bike::nbBikeTypes> available{};
+
+    /**
+     * @brief Bornes libres pouvant être réclamées : capacité moins les vélos stockés et les bornes réservées.
      */
-    std::array<std::deque<Bike*>, Bike::nbBikeTypes> storage;
+    std::atomic<long> freeSlotCount{0};
 
     /**
-     * @brief Flag indiquant l'arrêt de la simulation
+     * @brief Vélos à réviser, en attente du passage du van (non disponibles pour les personnes).
      */
-    bool endSimulation = false;
+    std::deque<Bike*> maintenance;
+
+    /**
+     * @brief Réservations actives de la station.
+     */
+    std::vector<ReservationEntry> reservations;
+
+    /**
+     * @brief Nombre de vélos mis de côté et de bornes réservées.
+     */
+    size_t reservedBikes = 0;
+    size_t reservedDocks = 0;
+
+    /**
+     * @brief Identifiant de la prochaine réservation, partagé par toutes les stations.
+     */
+    static std::atomic<unsigned long long> nextReservationId;
+
+    /**
+     * @brief Flag indiquant l'arrêt de la simulation (lu sans verrou par le chemin rapide)
+     */
+    std::atomic<bool> endSimulation{false};
+
+    /**
+     * @brief Chemin sans verrou : threads en cours et fermeture par freeze().
+     */
+    std::atomic<unsigned int> fastPathUsers{0};
+    std::atomic<bool> fastPathClosed{false};
+
+    /**
+     * @brief Threads bloqués dans le moniteur, par type de vélo et pour une borne.
+     *
+     * Le chemin rapide ne prend le mutex pour signaler que si l'un d'eux est non nul. L'attente
+     * incrémente son compteur avant de revérifier la ressource, le chemin rapide publie la
+     * ressource avant de lire le compteur (tous deux seq_cst) : un réveil ne peut pas être perdu.
+     */
+    std::array<std::atomic<unsigned int>, Bike::nbBikeTypes> waitingRiders{};
+    std::atomic<unsigned int> waitingDepositors{0};
+
+    /**
+     * @brief Phase active des attentes de vélo et de borne, chacune avec sa latence de remise.
+     */
+    AdaptiveSpin riderSpin;
+    AdaptiveSpin depositorSpin;
+
+    /**
+     * @brief Limites d'admission et nombre de demandes refusées.
+     */
+    const AdmissionLimits admission;
+    std::atomic<unsigned long long> overloadedCount{0};
+
+    /**
+     * @brief Journal des mutations de la station.
+     */
+    StationLog history;
+
+    /**
+     * @brief Index global du déséquilibre et rang de la station dans celui-ci (nul si non suivie).
+     */
+    ImbalanceIndex* imbalance = nullptr;
+    unsigned int imbalanceSite = 0;
 
 
     // SYNCHRONISATION
 
-    PcoMutex mutex;
+    /**
+     * @brief Verrou du moniteur (instrumenté si LOCK_PROFILING est défini).
+     */
+    StationLock mutex;
 
     /**
      * @brief Variables de condition pour les vélos de chaque type.
@@ -156,6 +719,25 @@ private:
      * Un thread attend ici si la station est pleine.
      */
     PcoConditionVariable slots_available;
+
+    /**
+     * @brief Signalée quand une réservation expire après ending() (attendue par le destructeur).
+     */
+    PcoConditionVariable reservation_expired;
+
+
+    // COMPTEURS PUBLIÉS (seqlock, écrits sous le mutex, lus sans verrou ; les comptes par type sont dans available)
+
+    /**
+     * @brief Numéro de séquence, impair pendant une mutation sous le mutex.
+     */
+    std::atomic<unsigned int> sequence{0};
+
+    std::atomic<size_t> publishedMaintenance{0};
+
+    std::atomic<size_t> publishedReservedBikes{0};
+
+    std::atomic<size_t> publishedReservedDocks{0};
 };
 
 #endif // BIKESTATION_H
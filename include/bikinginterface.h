@@ -11,24 +11,38 @@
 #define BIKINGINTERFACE_H
 
 #include <QObject>
+#include <QTimer>
+
+#include <atomic>
+#include <memory>
 
 #include "mainwindow.h"
+#include "boundedqueue.h"
+#include "logmessage.h"
+#include "simulationview.h"
 
 /**
   \brief Classe permettant aux threads d'interagir avec la partie graphique.
 
   Cette classe permet d'interagir avec la partie graphique de l'application.
-  Elle utilise le concept de signaux et slots afin d'envoyer les commandes
-  à l'interface graphique, et peut donc être appelée par des threads, ce qui
-  ne serait pas possible sinon.
+  Les commandes sont déposées sous forme d'événements de taille fixe dans une
+  file sans verrou, que le thread graphique vide par lots à intervalle
+  régulier : elle peut donc être appelée par des threads, sans allocation ni
+  verrou du côté de la simulation. Les entrées du journal ne peuvent pas
+  occuper les GUI_EVENT_RESERVED dernières cases de la file, gardées pour les
+  déplacements ; une entrée qui ne trouve pas de place est perdue et comptée,
+  et le nombre d'événements perdus est affiché dans le journal. Le nombre de
+  vélos des sites ne passe pas par la file : chaque site a sa dernière valeur
+  et un indicateur de modification, repris à chaque vidage, si bien qu'aucune
+  mise à jour n'est perdue.
 
   Les commandes permettent de:
-  \li afficher un message dans un parmi plusieurs consoles
+  \li ajouter une entrée au journal, attribuée à une source
   \li définir le nombre de vélos présents sur un site
   \li faire se déplacer un vélo entre deux sites
   \li faire se déplacer la camionette entre deux sites
   */
-class BikingInterface : public QObject
+class BikingInterface : public QObject, public SimulationView
 {
     Q_OBJECT
 
@@ -59,6 +73,18 @@ public:
       */
     void consoleAppendText(unsigned int consoleId,QString text);
 
+    /**
+      \brief Ajoute une entrée au journal, mise en forme seulement à l'affichage.
+      \param entityId Source de l'entrée : 0 pour le système et le van,
+             l'identifiant de la personne sinon.
+      \param message Identifiant du message.
+      \param arg0 Premier argument du message (voir LogMessage).
+      \param arg1 Deuxième argument du message.
+      \param arg2 Troisième argument du message.
+      */
+    void log(unsigned int entityId,LogMessage message,
+             long long arg0=0,long long arg1=0,long long arg2=0) override;
+
     /**
       \brief Définition du nombre de vélos sur un site.
 
@@ -68,7 +94,7 @@ public:
              correspond au local de maintenance.
       \param nbBike Nombre de vélos à affecter.
       */
-    void setBikes(unsigned int site,unsigned int nbBike);
+    void setBikes(unsigned int site,unsigned int nbBike) override;
 
     /**
       \brief Définition du nombre de vélos sur un site.
@@ -113,12 +139,12 @@ public:
              correspond au local de maintenance.
       \param ms Nombre de millisecondes de l'animation.
       */
-    void travel(unsigned int personId,unsigned int site1, unsigned int site2,unsigned int ms);
+    void travel(unsigned int personId,unsigned int site1, unsigned int site2,unsigned int ms) override;
 
     void walk(unsigned int personId,
               unsigned int site1,
               unsigned int site2,
-              unsigned int ms);
+              unsigned int ms) override;
     /**
       \brief Déplace la camionette d'un site à l'autre
 
@@ -136,62 +162,59 @@ public:
              correspond au local de maintenance.
       \param ms Nombre de millisecondes de l'animation.
      */
-    void vanTravel(unsigned int site1, unsigned int site2,unsigned int ms);
-
-private:
-
-    //! Indique si la fonction d'initialisation a déjà été appelée
-    static bool sm_didInitialize;
-    //! Fenêtre principale de l'application
-    static MainWindow *mainWindow;
+    void vanTravel(unsigned int site1, unsigned int site2,unsigned int ms) override;
 
-signals:
+private slots:
     /**
-      Signal envoyé à la fenêtre principale pour l'ajout d'un message
-      \param consoleId Identifiant de la console. Attention, doit être compris
-             entre 0 et nombre_de_consoles-1.
-      \param text Texte à ajouter à la console.
+      \brief Vide la file d'événements et applique les commandes.
+
+      Appelée périodiquement dans le thread graphique.
       */
-    void sig_consoleAppendText(unsigned int consoleId,QString text);
+    void drainEvents();
+
+private:
 
     /**
-      Signal envoyé à la fenêtre principale pour la définition du nombre de
-      vélos présents sur un site.
-      \param site Identifiant du site. Attention, doit être compris entre
-             0 et nombre_de_sites. Le site d'identifiant nombre_de_sites
-             correspond au local de maintenance.
-      \param nbBike Nombre de vélos à affecter.
+      \brief Commande en attente d'affichage, copiable telle quelle.
       */
-    void sig_setBikes(unsigned int site,unsigned int nbBike);
+    struct GuiEvent
+    {
+        enum Kind : unsigned char { Log, Travel, Walk, VanTravel };
+
+        Kind kind;
+        //! Arguments de la commande, dans l'ordre de la fonction correspondante
+        unsigned int args[4];
+        //! Entrée du journal
+        LogRecord record;
+        //! Texte d'une entrée LogMessage::Text (UTF-16, tronqué)
+        unsigned short length;
+        char16_t text[GUI_EVENT_TEXT_LENGTH];
+    };
 
     /**
-      Signal envoyé à la fenêtre principale pour déplacer un vélo d'un site à
-      l'autre.
-      \param personId Identifiant de la personne empruntant le vélo
-      \param site1 Identifiant du site de départ. Attention, doit être compris
-             entre 0 et nombre_de_sites. Le site d'identifiant nombre_de_sites
-             correspond au local de maintenance.
-      \param site2 Identifiant du site d'arrivée. Attention, doit être compris
-             entre 0 et nombre_de_sites. Le site d'identifiant nombre_de_sites
-             correspond au local de maintenance.
-      \param ms Nombre de millisecondes de l'animation.
+      \brief Dépose un événement dans la file, sans bloquer.
+      \param event Événement à déposer ; perdu si la file est pleine, ou si
+             c'est une entrée du journal et que seule la réserve est libre.
       */
-    void sig_travel(unsigned int personId,unsigned int site1, unsigned int site2,unsigned int ms);
+    void post(const GuiEvent &event);
 
-    void sig_walk(unsigned int,unsigned int,unsigned int,unsigned int);
+    //! Indique si la fonction d'initialisation a déjà été appelée
+    static bool sm_didInitialize;
+    //! Nombre de sites, sans le local de maintenance
+    static unsigned int sm_nbSites;
+    //! Fenêtre principale de l'application
+    static MainWindow *mainWindow;
 
-    /**
-      Signal envoyé à la fenêtre principale pour déplacer la camionette de
-      maintenance d'un site à l'autre.
-      \param site1 Identifiant du site de départ. Attention, doit être compris
-             entre 0 et nombre_de_sites. Le site d'identifiant nombre_de_sites
-             correspond au local de maintenance.
-      \param site2 Identifiant du site d'arrivée. Attention, doit être compris
-             entre 0 et nombre_de_sites. Le site d'identifiant nombre_de_sites
-             correspond au local de maintenance.
-      \param ms Nombre de millisecondes de l'animation.
-      */
-    void sig_vanTravel(unsigned int site1, unsigned int site2,unsigned int ms);
+    //! Événements en attente, déposés par les threads et retirés par le thread graphique
+    BoundedQueue<GuiEvent> m_events;
+    //! Nombre d'événements perdus depuis le dernier vidage
+    std::atomic<unsigned long long> m_dropped{0};
+    //! Dernier nombre de vélos de chaque site, local de maintenance compris
+    std::unique_ptr<std::atomic<unsigned int>[]> m_bikes;
+    //! Sites dont le nombre de vélos a changé depuis le dernier vidage
+    std::unique_ptr<std::atomic<bool>[]> m_bikesChanged;
+    //! Minuterie du vidage de la file
+    QTimer m_drainTimer;
 };
 
 #endif // BIKINGINTERFACE_H
@@ -0,0 +1,155 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : boundedqueue.h
+ * File bornée multi-producteurs multi-consommateurs sans verrou (algorithme de D. Vyukov) :
+ * un tableau circulaire dont chaque case porte un numéro de séquence indiquant si elle est
+ * libre ou occupée pour le tour courant. Une insertion ou un retrait coûte un CAS sur la
+ * position et une écriture de séquence, sans jamais entrer dans le noyau.
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Bounded lock-free MPMC FIFO queue.
+ *
+ * tryPush() fails when the queue is full and tryPop() when it is empty,
+ * including transiently while another thread is in the middle of an
+ * operation on the cell concerned.
+ *
+ * @tparam T Trivially copyable element type.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+    BoundedQueue() = default;
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Allocates room for at least @p _minCapacity elements.
+     *
+     * Must be called once, before the queue is shared.
+     */
+    void allocate(size_t _minCapacity) {
+        size_t size = 2;
+        while (size < _minCapacity)
+            size <<= 1;
+
+        cells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        mask = size - 1;
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Appends an element.
+     *
+     * @return false if the queue is full.
+     */
+    bool tryPush(const T& _value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                // Case libre pour ce tour : on tente de la réserver
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = _value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Removes the oldest element.
+     *
+     * @return false if the queue is empty.
+     */
+    bool tryPop(T& _value) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                // Case remplie pour ce tour : on tente de la prendre
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    _value = cell.data;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the number of cells of the queue.
+     */
+    size_t capacity() const { return mask + 1; }
+
+    /**
+     * @brief Returns the number of elements, possibly stale while other threads use the queue.
+     */
+    size_t sizeApprox() const {
+        // Retraits lus en premier ; sans ordre entre les deux positions, un
+        // retrait peut paraître en avance sur son ajout : on borne à zéro
+        size_t head = dequeuePos.load(std::memory_order_acquire);
+        size_t tail = enqueuePos.load(std::memory_order_acquire);
+        return tail < head ? 0 : tail - head;
+    }
+
+    /**
+     * @brief Calls a function on every element, oldest first.
+     *
+     * Only valid while no other thread uses the queue.
+     */
+    template<class F>
+    void forEach(F&& _f) const {
+        size_t end = enqueuePos.load(std::memory_order_acquire);
+        for (size_t pos = dequeuePos.load(std::memory_order_acquire); pos != end; ++pos)
+            _f(cells[pos & mask].data);
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence{0};
+        T data{};
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+
+    // Positions sur des lignes de cache distinctes : producteurs et consommateurs ne se gênent pas
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,219 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : checkpoint.h
+ * Sauvegarde et reprise de l'état complet de la simulation : vélos (usure comprise), contenu des
+ * stations, position et chargement du van, position des personnes et état de leurs générateurs
+ * aléatoires. Les agents publient leur état à chaque point de quiescence (avant et après chaque
+ * attente) ; une sauvegarde ne fait attendre que les agents actifs, le temps de copier l'état.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pcosynchro/pcomutex.h>
+#include <pcosynchro/pcoconditionvariable.h>
+
+#include "config.h"
+#include "bike.h"
+#include "bikestation.h"
+#include "fastrng.h"
+
+/**
+ * @brief State of one agent (person or van) as saved in a checkpoint.
+ */
+struct AgentState
+{
+    enum Kind : unsigned char { PersonAgent = 0, VanAgent = 1 };
+
+    Kind kind = PersonAgent;
+
+    unsigned int id = 0;
+
+    /**
+     * @brief Site where the agent is, or where it is heading to.
+     */
+    unsigned int site = 0;
+
+    unsigned int homeSite = 0;
+
+    unsigned int preferredType = 0;
+
+    /**
+     * @brief Identifiers of the bikes held (ridden bike, van cargo).
+     */
+    std::vector<unsigned int> bikes;
+
+    /**
+     * @brief State of the random generator of the agent thread.
+     */
+    FastRng::State rng{};
+};
+
+/**
+ * @brief Saved state of a bike.
+ */
+struct BikeRecord
+{
+    unsigned int id = 0;
+    unsigned int bikeType = 0;
+    unsigned int nbRides = 0;
+    unsigned long long totalRideTimeMs = 0;
+    unsigned int ridesSinceService = 0;
+    bool needsMaintenance = false;
+};
+
+/**
+ * @brief Complete state of a simulation, as written to or read from a file.
+ */
+struct SimulationState
+{
+    unsigned long long simTimeMs = 0;
+
+    std::vector<BikeRecord> bikes;
+
+    /**
+     * @brief Identifiers of the bikes docked at each station (depot last).
+     *
+     * Bikes that were neither docked nor held by an agent when the
+     * checkpoint was taken (between a station call and the next quiescent
+     * point of their agent) are put in the depot.
+     */
+    std::array<std::vector<unsigned int>, NB_SITES_TOTAL> stations;
+
+    std::vector<AgentState> agents;
+};
+
+/**
+ * @brief Quiescent-point barrier and binary snapshots of the simulation.
+ *
+ * Each agent owns a slot where it publishes its state. Before waiting
+ * (station, trip, pause) it marks itself away; when it comes back it
+ * publishes its new state and parks if a checkpoint is in progress. A
+ * checkpoint therefore only waits for the agents currently computing,
+ * locks the stations just long enough to copy their content, and releases
+ * everybody before the file is written.
+ *
+ * Publishing costs an uncontended per-slot lock and an atomic store; the
+ * global lock is only taken while a checkpoint is in progress.
+ */
+class Checkpoint
+{
+    enum Status : int { Present, Away, Parked, Finished };
+
+public:
+    /**
+     * @brief Slot where an agent publishes its state.
+     *
+     * Opaque for the agents: they only keep the pointer returned by
+     * registerAgent(), so publishing never touches the shared slot list.
+     */
+    class Slot
+    {
+        friend class Checkpoint;
+
+        PcoMutex mutex;
+        AgentState state;
+        std::atomic<int> status{Present};
+    };
+
+    /**
+     * @brief Returns the checkpoint coordinator shared by the simulation.
+     */
+    static Checkpoint& instance();
+
+    /**
+     * @brief Registers the calling agent.
+     *
+     * @param _state Initial state of the agent.
+     * @return Slot of the agent, to pass to the other functions.
+     */
+    Slot* registerAgent(const AgentState& _state);
+
+    /**
+     * @brief Publishes the state of an agent about to wait.
+     *
+     * @param _slot Slot returned by registerAgent().
+     * @param _state State of the agent during the wait.
+     */
+    void leave(Slot* _slot, const AgentState& _state);
+
+    /**
+     * @brief Publishes the state of an agent back from a wait.
+     *
+     * Parks the agent until the checkpoint in progress, if any, is taken.
+     *
+     * @param _slot Slot returned by registerAgent().
+     * @param _state New state of the agent.
+     */
+    void arrive(Slot* _slot, const AgentState& _state);
+
+    /**
+     * @brief Marks an agent whose thread has ended.
+     *
+     * @param _slot Slot returned by registerAgent().
+     */
+    void finish(Slot* _slot);
+
+    /**
+     * @brief Takes a checkpoint and writes it to a file.
+     *
+     * @param _path File to write.
+     * @param _stations All stations (sites + depot).
+     * Blocks the caller up to CHECKPOINT_TIMEOUT_MS while the agents reach
+     * a quiescent point: call it from a thread other than the GUI.
+     *
+     * @param _fleet Every bike of the simulation; must not change during the call.
+     * @return true if the file has been written, false if an agent was still
+     *         active at the timeout (nothing is written) or on a write error.
+     */
+    bool save(const std::string& _path,
+              const std::array<BikeStation*, NB_SITES_TOTAL>& _stations,
+              const std::vector<Bike*>& _fleet);
+
+    /**
+     * @brief Reads a checkpoint file.
+     *
+     * Rejects unknown bike types, duplicate bike identifiers, bikes placed
+     * twice or never saved, and agents holding more bikes than they can.
+     *
+     * @param _path File to read.
+     * @param _state Filled with the saved state.
+     * @return true if the file is a valid checkpoint for this configuration.
+     */
+    static bool load(const std::string& _path, SimulationState& _state);
+
+private:
+    Checkpoint() = default;
+
+    /**
+     * @brief Indicates that every agent is away, parked or finished; mutex must be held.
+     */
+    bool quiescent() const;
+
+    std::vector<std::unique_ptr<Slot>> slots;
+
+    std::atomic<bool> requested{false};
+
+    PcoMutex mutex;
+
+    /**
+     * @brief Signalée quand un agent s'absente ou se parque pendant une sauvegarde.
+     */
+    PcoConditionVariable agentChanged;
+
+    /**
+     * @brief Signalée quand la sauvegarde libère les agents parqués.
+     */
+    PcoConditionVariable released;
+};
+
+#endif // CHECKPOINT_H
@@ -3,6 +3,8 @@
 
 #include <random>
 #include <cstddef>
+#include "fastrng.h"
+#include "waitpolicy.h"
 
 /**
  * @brief Number of bike-sharing sites (excluding the depot).
@@ -41,26 +43,223 @@ const size_t NBPEOPLE = 10;
  */
 const size_t VAN_CAPACITY = 4;
 
+/**
+ * @brief Number of most starved sites, of most saturated sites and of sites
+ *        with the most flagged bikes the van considers when planning a tour.
+ *
+ * Taken from the global imbalance index, so that planning does not read
+ * every site of a large network.
+ */
+const size_t VAN_TOUR_CANDIDATES = 8;
+
+/**
+ * @brief Number of rides after which a bike is flagged for maintenance.
+ *
+ * Flagged bikes are no longer handed to riders; the van collects them and
+ * brings them back to the depot where they are serviced.
+ */
+const size_t MAINTENANCE_RIDES = 10;
+
+/**
+ * @brief File describing the coordinates of the sites.
+ *
+ * One "x y" line per site, the depot last. Lines starting with '#' are
+ * ignored. If the file is missing, sites are laid out on a circle.
+ */
+const char* const SITES_FILE = "sites.txt";
+
+/**
+ * @brief Fixed part of a travel time between two sites, in milliseconds.
+ */
+const unsigned int TRAVEL_BASE_MS = 500;
+
+/**
+ * @brief Travel time per unit of distance between two sites, in milliseconds.
+ */
+const double TRAVEL_MS_PER_UNIT = 3.0;
+
+/**
+ * @brief Number of nearest sites a person considers as destination.
+ *
+ * With NBSITES - 1 every other site can be chosen.
+ */
+const size_t SITE_NEIGHBOURS = NBSITES - 1;
+
+/**
+ * @brief File describing the origin-destination demand of the riders.
+ *
+ * One or more time-of-day profiles, each made of NBSITES lines of NBSITES
+ * non-negative weights (line = origin, column = destination). Lines starting
+ * with '#' are ignored. If the file is missing, destinations are drawn among
+ * the nearest sites.
+ */
+const char* const DEMAND_FILE = "demand.txt";
+
+/**
+ * @brief Duration of a simulated day in milliseconds.
+ *
+ * The demand profiles split this duration into equal periods and repeat
+ * every simulated day.
+ */
+const unsigned int SIM_DAY_MS = 240'000;
+
+/**
+ * @brief Resolution of the simulation timer wheel, in simulated milliseconds.
+ */
+const unsigned int TIMER_TICK_MS = 10;
+
+/**
+ * @brief Speed of the simulated clock relative to real time.
+ *
+ * 1.0 runs in real time; 10.0 makes every trip, pause and reservation
+ * ten times shorter in real time.
+ */
+const double TIME_SCALE = 1.0;
+
+/**
+ * @brief Pause of the van at the depot between two tours, in milliseconds.
+ */
+const unsigned int VAN_PAUSE_MS = 2000;
+
+/**
+ * @brief Extra time granted to a reservation on top of the travel time.
+ */
+const unsigned int RESERVATION_MARGIN_MS = 1000;
+
+/**
+ * @brief Number of destinations a person tries before riding without a
+ *        dock reservation.
+ */
+const size_t RESERVATION_ATTEMPTS = 3;
+
+/**
+ * @brief File written by the "Checkpoint" action and read by --restore.
+ */
+const char* const CHECKPOINT_FILE = "simulation.ckpt";
+
+/**
+ * @brief Maximum real time a checkpoint waits for agents to reach a
+ *        quiescent point, in milliseconds.
+ */
+const unsigned int CHECKPOINT_TIMEOUT_MS = 2000;
+
+/**
+ * @brief File written by the "Latency" action with the full wait-time histograms.
+ */
+const char* const LATENCY_FILE = "latency.csv";
+
+/**
+ * @brief Period of the lock contention reports (WITH_LOCK_PROFILING builds),
+ *        in simulated milliseconds.
+ */
+const unsigned int LOCK_REPORT_PERIOD_MS = 5000;
+
+/**
+ * @brief Number of station locks listed in each contention report.
+ */
+const unsigned int LOCK_REPORT_TOP = 3;
+
+/**
+ * @brief Spin-then-park policy of the sites: riders and depositors spin up
+ *        to 50 us when recent hand-offs were that fast, 2 us otherwise.
+ */
+const WaitPolicy SITE_WAIT_POLICY{2'000, 50'000};
+
+/**
+ * @brief Spin-then-park policy of the depot: only the vans use it, in bulk,
+ *        so waiters park at once.
+ */
+const WaitPolicy DEPOT_WAIT_POLICY{0, 0};
+
+/**
+ * @brief Admission limits of the sites: riders blocked waiting for a bike
+ *        of one type, and riders blocked waiting for a dock. A rider beyond
+ *        the limit is redirected to a nearby site.
+ */
+const size_t MAX_WAITING_RIDERS = 3;
+const size_t MAX_WAITING_DEPOSITORS = 3;
+
+/**
+ * @brief Size of the event ring of each station log, and number of
+ *        snapshots kept to reconstruct past states.
+ */
+const size_t STATION_LOG_EVENTS = 1024;
+const size_t STATION_LOG_SNAPSHOTS = 64;
+
+/**
+ * @brief Number of display events the simulation threads can queue for the
+ *        GUI; events posted while the queue is full are dropped and counted.
+ */
+const size_t GUI_EVENT_QUEUE_SIZE = 8192;
+
+/**
+ * @brief Part of the display event queue kept for the moves of persons and
+ *        van: log entries are dropped once fewer free cells remain.
+ */
+const size_t GUI_EVENT_RESERVED = 2048;
+
+/**
+ * @brief Period, in real milliseconds, at which the GUI drains the event queue.
+ */
+const unsigned int GUI_DRAIN_PERIOD_MS = 16;
+
+/**
+ * @brief Maximum length (UTF-16 code units) of a console message; longer
+ *        messages are truncated.
+ */
+const size_t GUI_EVENT_TEXT_LENGTH = 94;
+
+/**
+ * @brief Number of entries retained by the log panel of the main window.
+ */
+const size_t LOG_MAX_ROWS = 200'000;
+
+/**
+ * @brief File receiving the entries evicted from the log panel; empty to
+ *        discard them.
+ */
+const char* const LOG_SPILL_FILE = "simulation.log";
+
+/**
+ * @brief Simulated duration covered by one column of the occupancy
+ *        dashboard, and number of columns retained.
+ */
+const unsigned int OCCUPANCY_COLUMN_MS = 5000;
+const size_t OCCUPANCY_COLUMNS = 120;
+
+/**
+ * @brief Simulated interval at which the sweep runner samples the depth of
+ *        the waiting queues of the sites.
+ */
+const unsigned int QUEUE_SAMPLE_MS = 1000;
+
+/**
+ * @brief Period, in real milliseconds, at which the occupancy dashboard
+ *        samples the stations.
+ */
+const unsigned int OCCUPANCY_POLL_MS = 100;
+
 /**
  * @brief Thread-local random number generator used for the simulation.
+ *
+ * One instance per thread, shared by all translation units.
  */
-static thread_local std::mt19937_64 c_rng(std::random_device{}());
+inline thread_local FastRng c_rng(std::random_device{}());
 
 /**
  * @brief Returns a random site index different from a given one.
  *
+ * Draws among the @p maxSite - 1 allowed sites and shifts the values at or
+ * above @p exclude, so no retry is ever needed.
+ *
  * @param maxSite Number of valid sites (exclusive upper bound).
  * @param exclude Site index that must not be chosen.
  * @return Random site index in [0, maxSite) and != @p exclude.
  */
 inline unsigned int randomSiteExcept(unsigned int maxSite, unsigned int exclude)
 {
-    std::uniform_int_distribution<unsigned int> dist(0, maxSite - 1);
-    unsigned int s;
-    do {
-        s = dist(c_rng);
-    } while (s == exclude);
-    return s;
+    unsigned int s = c_rng.below(maxSite - 1);
+    return s + (s >= exclude);
 }
 
 /**
@@ -72,8 +271,7 @@ inline unsigned int randomSiteExcept(unsigned int maxSite, unsigned int exclude)
  */
 inline unsigned int randomTravelTimeMs()
 {
-    std::uniform_int_distribution<unsigned int> dist(500, 2000);
-    return dist(c_rng);
+    return 500 + c_rng.below(1501);
 }
 
 #endif // CONFIG_H
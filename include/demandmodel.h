@@ -0,0 +1,103 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : demandmodel.h
+ * Cette classe représente la demande des usagers sous forme de matrices origine-destination,
+ * une par période de la journée simulée. Pour chaque période et chaque site d'origine,
+ * une table d'alias (méthode de Vose) permet de tirer une destination en temps constant.
+ */
+
+#ifndef DEMANDMODEL_H
+#define DEMANDMODEL_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include "config.h"
+
+/**
+ * @brief Origin-destination demand model with time-of-day profiles.
+ *
+ * Each profile is an NBSITES x NBSITES matrix of weights. The weights of an
+ * origin are turned into an alias table, so drawing a destination costs one
+ * bounded integer, one real number and one comparison whatever the number of
+ * sites.
+ *
+ * Once built, a DemandModel is read-only and can be shared by all threads.
+ */
+class DemandModel
+{
+public:
+    /**
+     * @brief Builds a uniform demand: every other site is equally likely.
+     */
+    DemandModel();
+
+    /**
+     * @brief Loads the demand profiles from a file.
+     *
+     * The file contains NBSITES lines of NBSITES weights per profile, the
+     * profiles one after the other. The diagonal is ignored (a trip always
+     * goes to another site) and an origin whose weights are all zero falls
+     * back to a uniform choice. If the file cannot be read or is malformed,
+     * the current profiles are kept.
+     *
+     * @param _path Path of the file to read.
+     * @return true if the profiles have been loaded from the file.
+     */
+    bool loadFromFile(const std::string& _path);
+
+    /**
+     * @brief Number of time-of-day profiles.
+     */
+    size_t nbProfiles() const { return profiles.size(); }
+
+    /**
+     * @brief Returns the profile active at the current simulated time.
+     *
+     * The simulated day follows the clock of the timer wheel and lasts
+     * @ref SIM_DAY_MS simulated milliseconds.
+     */
+    size_t currentProfile() const;
+
+    /**
+     * @brief Draws a destination for a trip starting at a given site.
+     *
+     * @param _from Origin site index (0..NBSITES-1).
+     * @param _profile Profile index (0..nbProfiles()-1).
+     * @return Destination site index, always different from @p _from.
+     */
+    unsigned int sample(unsigned int _from, size_t _profile) const;
+
+private:
+    /**
+     * @brief Table d'alias pour un site d'origine.
+     */
+    struct AliasTable
+    {
+        std::array<float, NBSITES> prob{};
+        std::array<unsigned int, NBSITES> alias{};
+    };
+
+    using Profile = std::array<AliasTable, NBSITES>;
+
+    /**
+     * @brief Builds the alias table of one origin from its weights.
+     *
+     * @param _from Origin site index, whose own weight is ignored.
+     * @param _weights Weights of every destination.
+     * @param _table Table to fill.
+     */
+    static void buildTable(unsigned int _from,
+                           const std::array<double, NBSITES>& _weights,
+                           AliasTable& _table);
+
+    /**
+     * @brief Tables d'alias par période puis par site d'origine.
+     */
+    std::vector<Profile> profiles;
+};
+
+#endif // DEMANDMODEL_H
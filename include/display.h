@@ -11,6 +11,12 @@
 
 #include <QGraphicsView>
 #include <QGraphicsItem>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <vector>
+
+class SiteMap;
 
 
 class BikeItem :  public QObject, public QGraphicsPixmapItem
@@ -36,7 +42,7 @@ class BikeDisplay : public QGraphicsView
 {
     Q_OBJECT
 public:
-    BikeDisplay(unsigned int nbSite,QWidget *parent=0);
+    BikeDisplay(unsigned int nbSite,const SiteMap *siteMap=0,QWidget *parent=0);
     unsigned int m_nbSite;
     QList<BikeItem *> *m_sites;
     QPointF *m_sitePos;
@@ -52,14 +58,38 @@ private:
 
     PersonItem *getPerson(unsigned int personId);
 
+    //! Trajet en cours : un élément interpolé entre deux positions
+    struct Trip
+    {
+        enum Kind { BikeTrip, PersonTrip, VanTrip };
+
+        Kind kind;
+        QGraphicsPixmapItem *item;
+        QPointF from;
+        QPointF to;
+        qint64 startMs;
+        qint64 durationMs;
+    };
+
+    //! Ajoute un trajet et démarre le tic d'animation si nécessaire
+    void startTrip(Trip::Kind kind,QGraphicsPixmapItem *item,QPointF from,
+                   QPointF to,unsigned int ms);
+
+    //! Trajets en cours ; le tableau garde sa capacité d'un trajet à l'autre
+    std::vector<Trip> m_trips;
+    //! Horloge des trajets et tic d'animation, actif seulement s'il y a des trajets
+    QElapsedTimer m_clock;
+    QTimer m_frameTimer;
+
+private slots:
+    void advanceTrips();
+
 public slots:
     void setBikes(unsigned int site,unsigned int nbBike);
     void setPerson(unsigned int site, unsigned int personID);
     void travel(unsigned int personId,unsigned int site1, unsigned int site2,unsigned int ms);
     void walk(unsigned int personId,unsigned int site1, unsigned int site2,unsigned int ms);
-    void finishedAnimation();
     void vanTravel(unsigned int site1, unsigned int site2,unsigned int ms);
-    void finishedVanAnimation();
 };
 
 #endif // DISPLAY_H
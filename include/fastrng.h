@@ -0,0 +1,133 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : fastrng.h
+ * Générateur pseudo-aléatoire rapide (xoshiro256**) utilisé par chaque thread de la simulation.
+ * Son état tient en 32 octets et il fournit des tirages bornés sans division ni allocation
+ * (méthode de Lemire), ainsi que des réels uniformes dans [0, 1).
+ */
+
+#ifndef FASTRNG_H
+#define FASTRNG_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Small, fast and seedable random generator (xoshiro256**).
+ *
+ * Satisfies the UniformRandomBitGenerator requirements, so it can still be
+ * used with the standard distributions, but the simulation uses the
+ * dedicated @ref below and @ref nextFloat draws which are much cheaper.
+ */
+class FastRng
+{
+public:
+    using result_type = std::uint64_t;
+
+    /**
+     * @brief Complete state of the generator, e.g. for checkpoints.
+     */
+    using State = std::array<std::uint64_t, 4>;
+
+    /**
+     * @brief Constructs a generator from a seed.
+     *
+     * @param _seed Any value; it is expanded with splitmix64 so that close
+     *        seeds give unrelated sequences.
+     */
+    explicit FastRng(std::uint64_t _seed = 0x9E3779B97F4A7C15ull) { seed(_seed); }
+
+    /**
+     * @brief Reseeds the generator.
+     *
+     * @param _seed New seed.
+     */
+    void seed(std::uint64_t _seed)
+    {
+        for (auto& word : s) {
+            _seed += 0x9E3779B97F4A7C15ull;
+            std::uint64_t z = _seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    /**
+     * @brief Returns the next 64 random bits.
+     */
+    std::uint64_t next()
+    {
+        const std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const std::uint64_t t = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+
+        return result;
+    }
+
+    std::uint64_t operator()() { return next(); }
+
+    static constexpr std::uint64_t min() { return 0; }
+    static constexpr std::uint64_t max() { return std::numeric_limits<std::uint64_t>::max(); }
+
+    /**
+     * @brief Returns a uniform integer in [0, @p _bound).
+     *
+     * Uses Lemire's multiply-shift reduction: a single multiplication in the
+     * common case, with a rejection step that is taken with probability
+     * below @p _bound / 2^32.
+     *
+     * @param _bound Exclusive upper bound, must be greater than 0.
+     */
+    std::uint32_t below(std::uint32_t _bound)
+    {
+        std::uint64_t m = (next() >> 32) * _bound;
+        std::uint32_t low = static_cast<std::uint32_t>(m);
+        if (low < _bound) {
+            const std::uint32_t threshold = static_cast<std::uint32_t>(-_bound) % _bound;
+            while (low < threshold) {
+                m = (next() >> 32) * _bound;
+                low = static_cast<std::uint32_t>(m);
+            }
+        }
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+
+    /**
+     * @brief Returns a uniform real number in [0, 1).
+     */
+    float nextFloat()
+    {
+        return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    /**
+     * @brief Returns the current state of the generator.
+     */
+    const State& state() const { return s; }
+
+    /**
+     * @brief Restores a state previously returned by @ref state.
+     */
+    void setState(const State& _state) { s = _state; }
+
+private:
+    static std::uint64_t rotl(std::uint64_t _x, int _k)
+    {
+        return (_x << _k) | (_x >> (64 - _k));
+    }
+
+    State s;
+};
+
+#endif // FASTRNG_H
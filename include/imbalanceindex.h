@@ -0,0 +1,166 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : imbalanceindex.h
+ * Index global du déséquilibre des sites : pour chaque site, l'écart entre son stock de vélos et
+ * la cible du van. Les stations le tiennent à jour à chaque mutation par un simple incrément
+ * atomique de la feuille du site et un bit « modifié » ; un arbre de segments (minimum et maximum
+ * de chaque intervalle de sites) est remis à jour sur les seuls chemins modifiés au moment d'une
+ * requête. Les k sites les plus en manque ou les plus pleins s'obtiennent alors sans parcourir
+ * les sites, en descendant l'arbre par ordre de priorité. Le nombre de vélos à réviser de chaque
+ * site est tenu de la même manière, pour que le van passe aussi aux sites équilibrés qui en ont.
+ */
+
+#ifndef IMBALANCEINDEX_H
+#define IMBALANCEINDEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <pcosynchro/pcomutex.h>
+
+/**
+ * @brief Network-wide index of the stock of every site relative to a target.
+ *
+ * The stock of a site is the number of bikes the van can rebalance: bikes
+ * available to riders and bikes held by reservations, flagged bikes
+ * excluded. The number of flagged bikes of every site is tracked apart, so
+ * that a site at target whose docks hold flagged bikes is still found.
+ * Updates are lock-free and O(1); a query first folds the sites updated
+ * since the previous one into the tree, in O(log n) each, then answers in
+ * O(k log n).
+ */
+class ImbalanceIndex
+{
+public:
+    /**
+     * @brief Site with its imbalance (stock minus target).
+     */
+    struct Entry
+    {
+        unsigned int site;
+        long imbalance;
+    };
+
+    /**
+     * @param _nbSites Number of sites indexed (0.._nbSites-1).
+     * @param _target Stock the van aims to leave at each site.
+     */
+    ImbalanceIndex(size_t _nbSites, long _target);
+
+    ImbalanceIndex(const ImbalanceIndex&) = delete;
+    ImbalanceIndex& operator=(const ImbalanceIndex&) = delete;
+
+    /**
+     * @brief Sets the stock of a site; lock-free, callable from any thread.
+     */
+    void set(unsigned int _site, long _stock);
+
+    /**
+     * @brief Changes the stock of a site; lock-free, callable from any thread.
+     */
+    void add(unsigned int _site, long _delta);
+
+    /**
+     * @brief Sets the number of flagged bikes of a site; lock-free, callable from any thread.
+     */
+    void setWorn(unsigned int _site, long _nbWorn);
+
+    /**
+     * @brief Changes the number of flagged bikes of a site; lock-free, callable from any thread.
+     */
+    void addWorn(unsigned int _site, long _delta);
+
+    /**
+     * @brief Returns the current imbalance of a site.
+     */
+    long imbalance(unsigned int _site) const;
+
+    /**
+     * @brief Returns up to @p _k sites below the target, largest deficit first.
+     */
+    std::vector<Entry> mostStarved(size_t _k);
+
+    /**
+     * @brief Returns up to @p _k sites above the target, largest surplus first.
+     */
+    std::vector<Entry> mostSaturated(size_t _k);
+
+    /**
+     * @brief Returns up to @p _k sites holding flagged bikes, most flagged bikes first.
+     *
+     * The imbalance of each entry is the one of the site, whatever its
+     * number of flagged bikes.
+     */
+    std::vector<Entry> mostWorn(size_t _k);
+
+    size_t nbSites() const { return count; }
+    long target() const { return goal; }
+
+private:
+    /**
+     * @brief Stock et vélos à réviser d'un site, sur sa propre ligne de cache : les stations ne se gênent pas.
+     */
+    struct alignas(64) Leaf
+    {
+        std::atomic<long> stock{0};
+        std::atomic<long> worn{0};
+    };
+
+    /**
+     * @brief Minimum et maximum des déséquilibres d'un intervalle de sites, et maximum de ses vélos à réviser.
+     */
+    struct Node
+    {
+        long min;
+        long max;
+        long worn;
+    };
+
+    /**
+     * @brief Ordre d'une requête : déficit, surplus ou vélos à réviser.
+     */
+    enum class Order
+    {
+        Starved,
+        Saturated,
+        Worn
+    };
+
+    static Node merge(const Node& _left, const Node& _right);
+
+    void markDirty(unsigned int _site);
+
+    /**
+     * @brief Reports dans l'arbre les sites modifiés ; le mutex doit être pris.
+     */
+    void refreshLocked();
+
+    /**
+     * @brief Descente par ordre de priorité selon @p _order.
+     */
+    std::vector<Entry> top(size_t _k, Order _order);
+
+    const size_t count;
+    const long goal;
+
+    std::unique_ptr<Leaf[]> leaves;
+
+    /**
+     * @brief Un bit par site modifié depuis la dernière requête.
+     */
+    std::unique_ptr<std::atomic<std::uint64_t>[]> dirty;
+    size_t nbDirtyWords;
+
+    // ARBRE (sous le mutex) : racine en 1, feuille du site s en size + s
+
+    PcoMutex mutex;
+    size_t size = 1;
+    std::vector<Node> tree;
+};
+
+#endif // IMBALANCEINDEX_H
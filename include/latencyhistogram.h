@@ -0,0 +1,173 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : latencyhistogram.h
+ * Histogrammes d'attente des personnes, à la manière de HdrHistogram : classes logarithmiques
+ * subdivisées linéairement, donc une précision relative constante (~3 %) de 1 ms à plusieurs
+ * heures simulées pour quelques kilo-octets. L'enregistreur garde un tampon par thread (un
+ * histogramme par site, type de vélo et genre d'attente) fusionné uniquement sur demande.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pcosynchro/pcomutex.h>
+
+#include "config.h"
+#include "bike.h"
+
+/**
+ * @brief Log-linear histogram of durations in milliseconds.
+ *
+ * Values below 2 * @ref subBuckets are counted exactly; above, each power
+ * of two is split into @ref subBuckets equal buckets. Values above
+ * @ref maxValue are clamped.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned int subBucketBits = 5;
+    static constexpr unsigned int subBuckets = 1u << subBucketBits;
+    static constexpr unsigned int maxShift = 26;
+    static constexpr unsigned int nbBuckets = 2 * subBuckets + maxShift * subBuckets;
+    static constexpr std::uint64_t maxValue = (std::uint64_t(2 * subBuckets) << maxShift) - 1;
+
+    /**
+     * @brief Records one duration.
+     *
+     * @param _ms Duration in milliseconds.
+     */
+    void record(std::uint64_t _ms);
+
+    /**
+     * @brief Adds the counts of another histogram to this one.
+     */
+    void merge(const LatencyHistogram& _other);
+
+    std::uint64_t count() const { return total; }
+    std::uint64_t max() const { return maxRecorded; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    /**
+     * @brief Returns the value below which a given fraction of the durations fall.
+     *
+     * @param _percentile Percentile in [0, 100].
+     * @return Upper bound of the bucket holding the percentile (0 if empty).
+     */
+    std::uint64_t percentile(double _percentile) const;
+
+    /**
+     * @brief Returns the bucket holding a value.
+     */
+    static unsigned int bucketOf(std::uint64_t _ms);
+
+    /**
+     * @brief Returns the smallest value counted in a bucket.
+     */
+    static std::uint64_t lowerBound(unsigned int _bucket);
+
+    /**
+     * @brief Returns the largest value counted in a bucket.
+     */
+    static std::uint64_t upperBound(unsigned int _bucket);
+
+    /**
+     * @brief Returns the number of values counted in a bucket.
+     */
+    std::uint64_t bucketCount(unsigned int _bucket) const { return counts[_bucket]; }
+
+private:
+    std::array<std::uint64_t, nbBuckets> counts{};
+    std::uint64_t total = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t maxRecorded = 0;
+};
+
+/**
+ * @brief Per-site, per-type histograms of the time riders wait at stations.
+ *
+ * Each recording thread owns a buffer, created on its first record, whose
+ * lock is only contended while a merge copies it. Histograms inside a
+ * buffer are allocated on first use, so a rider that only rents its
+ * preferred type only pays for the sites it visits.
+ */
+class LatencyRecorder
+{
+public:
+    /**
+     * @brief Kind of wait being measured.
+     */
+    enum Kind : unsigned int { Rent = 0, Dock = 1 };
+
+    static constexpr unsigned int nbKinds = 2;
+
+    /**
+     * @brief Merged histograms, indexed by [kind][site][type].
+     */
+    using Table = std::array<std::array<std::array<LatencyHistogram, Bike::nbBikeTypes>,
+                                        NB_SITES_TOTAL>, nbKinds>;
+
+    /**
+     * @brief Returns the recorder shared by the simulation.
+     */
+    static LatencyRecorder& instance();
+
+    /**
+     * @brief Records a wait of the calling thread.
+     *
+     * @param _kind Rent (time to get a bike) or Dock (time to return it).
+     * @param _site Site where the rider waited.
+     * @param _type Type of the bike.
+     * @param _ms Duration of the wait in simulated milliseconds.
+     */
+    void record(Kind _kind, unsigned int _site, size_t _type, std::uint64_t _ms);
+
+    /**
+     * @brief Merges the buffers of every thread.
+     */
+    std::unique_ptr<Table> merge() const;
+
+    /**
+     * @brief Formats a per-site summary (count, p50, p90, p99, max) of a merged table.
+     */
+    static std::string report(const Table& _table);
+
+    /**
+     * @brief Writes every non-empty bucket of a merged table as CSV.
+     *
+     * @param _path File to write.
+     * @param _table Merged histograms.
+     * @return true if the file has been written.
+     */
+    static bool dump(const std::string& _path, const Table& _table);
+
+private:
+    LatencyRecorder() = default;
+
+    static constexpr unsigned int nbSlots = nbKinds * NB_SITES_TOTAL * Bike::nbBikeTypes;
+
+    /**
+     * @brief Tampon d'un thread : un histogramme alloué à la demande par (genre, site, type).
+     */
+    struct Buffer
+    {
+        PcoMutex mutex;
+        std::array<std::unique_ptr<LatencyHistogram>, nbSlots> histograms;
+    };
+
+    Buffer* localBuffer();
+
+    mutable PcoMutex mutex;
+
+    std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,154 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : lockprofiler.h
+ * Verrou des stations, instrumentable à la compilation. Sans LOCK_PROFILING, StationLock se réduit
+ * à un PcoMutex et ses fonctions inline à de simples appels : aucun surcoût. Avec LOCK_PROFILING
+ * (option CMake WITH_LOCK_PROFILING), chaque verrou compte ses acquisitions, le temps d'attente,
+ * le temps de détention et la profondeur de la file d'attente ; un thread rapporteur échantillonne
+ * périodiquement ces compteurs et affiche les stations les plus disputées.
+ */
+
+#ifndef LOCKPROFILER_H
+#define LOCKPROFILER_H
+
+#include <pcosynchro/pcomutex.h>
+#include <pcosynchro/pcoconditionvariable.h>
+
+#ifdef LOCK_PROFILING
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#endif
+
+#ifdef LOCK_PROFILING
+
+/**
+ * @brief Counters of one profiled lock.
+ *
+ * Written by the threads using the lock, read at any time by the reporter,
+ * hence the relaxed atomics.
+ */
+struct LockStats
+{
+    std::atomic<std::uint64_t> acquisitions{0};
+
+    /**
+     * @brief Acquisitions that found the lock taken.
+     */
+    std::atomic<std::uint64_t> contended{0};
+
+    std::atomic<std::uint64_t> waitNs{0};
+    std::atomic<std::uint64_t> holdNs{0};
+
+    /**
+     * @brief Threads currently waiting to acquire the lock.
+     */
+    std::atomic<unsigned int> queueDepth{0};
+
+    std::atomic<unsigned int> maxQueueDepth{0};
+
+    /**
+     * @brief Threads currently blocked on a condition of the monitor.
+     */
+    std::atomic<unsigned int> conditionWaiters{0};
+};
+
+#endif // LOCK_PROFILING
+
+/**
+ * @brief Mutex of a station, profiled when LOCK_PROFILING is defined.
+ *
+ * Condition waits must go through wait() so that the time spent blocked
+ * on a condition is not counted as hold time.
+ */
+class StationLock
+{
+public:
+#ifdef LOCK_PROFILING
+    StationLock();
+    ~StationLock();
+
+    void lock();
+    void unlock();
+    void wait(PcoConditionVariable& _condition);
+
+    const LockStats& stats() const { return counters; }
+#else
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+    void wait(PcoConditionVariable& _condition) { _condition.wait(&mutex); }
+#endif
+
+private:
+    PcoMutex mutex;
+
+#ifdef LOCK_PROFILING
+    using Clock = std::chrono::steady_clock;
+
+    LockStats counters;
+
+    /**
+     * @brief Date of the last acquisition; only touched by the holder.
+     */
+    Clock::time_point acquiredAt;
+#endif
+};
+
+#ifdef LOCK_PROFILING
+
+/**
+ * @brief Registry of the profiled locks and periodic reporter.
+ *
+ * Locks are identified by their creation order: stations are created site
+ * by site, the depot last.
+ */
+class LockProfiler
+{
+public:
+    static LockProfiler& instance();
+
+    void add(const StationLock* _lock);
+    void remove(const StationLock* _lock);
+
+    /**
+     * @brief Prints the most contended locks every period until the timer wheel stops.
+     *
+     * Meant to run in its own thread. Each report covers the period just
+     * elapsed: acquisitions, contended share, wait and hold time, and the
+     * queue depth (sampled now and maximum since the start).
+     */
+    void runReporter();
+
+private:
+    LockProfiler() = default;
+
+    /**
+     * @brief Copie des compteurs d'un verrou lors du dernier rapport.
+     */
+    struct Sample
+    {
+        std::uint64_t acquisitions = 0;
+        std::uint64_t contended = 0;
+        std::uint64_t waitNs = 0;
+        std::uint64_t holdNs = 0;
+    };
+
+    struct Entry
+    {
+        const StationLock* lock;
+        unsigned int index;
+        Sample last;
+    };
+
+    PcoMutex mutex;
+    std::vector<Entry> entries;
+    unsigned int nextIndex = 0;
+};
+
+#endif // LOCK_PROFILING
+
+#endif // LOCKPROFILER_H
@@ -0,0 +1,57 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : logmessage.h
+ * Messages du journal de la simulation : chaque entrée est un identifiant de message et quelques
+ * arguments entiers, mis en forme seulement au moment de l'affichage. Les threads de la simulation
+ * n'ont ainsi aucune chaîne à construire pour journaliser.
+ */
+
+#ifndef LOGMESSAGE_H
+#define LOGMESSAGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Identifier of a log message; the comment lists its arguments.
+ */
+enum class LogMessage : std::uint16_t
+{
+    Text,               ///< Free text, stored aside
+    PersonPrefers,      ///< person, bike type
+    SiteOverloaded,     ///< person, overloaded site, site redirected to
+    VanStopped,         ///< -
+    VanServiced,        ///< number of bikes serviced
+    AgentsStopped,      ///< shutdown latency in microseconds
+    EventsDropped,      ///< number of display events dropped
+};
+
+/**
+ * @brief Number of integer arguments of a log entry.
+ */
+constexpr size_t LOG_NB_ARGS = 3;
+
+/**
+ * @brief One log entry, trivially copyable.
+ */
+struct LogRecord
+{
+    /**
+     * @brief Source of the entry: 0 for the system and the van, the person id otherwise.
+     */
+    std::uint32_t entity = 0;
+
+    LogMessage message = LogMessage::Text;
+
+    /**
+     * @brief Simulated time of the entry in milliseconds.
+     */
+    std::uint64_t timeMs = 0;
+
+    std::int64_t args[LOG_NB_ARGS] = {};
+};
+
+#endif // LOGMESSAGE_H
@@ -0,0 +1,130 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : logpanel.h
+ * Panneau unique du journal de la simulation, à la place d'une console par personne : toutes les
+ * sources sont multiplexées dans un LogStore, la vue filtre par source et recherche dans le texte.
+ * Le modèle ne tient qu'une liste de numéros d'entrées retenues par le filtre ; le texte d'une
+ * ligne n'est mis en forme que lorsque la vue l'affiche. Les ajouts d'un même tour de la boucle
+ * d'événements sont publiés à la vue en une seule insertion.
+ */
+
+#ifndef LOGPANEL_H
+#define LOGPANEL_H
+
+#include <QAbstractTableModel>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QTableView>
+#include <QTimer>
+#include <QWidget>
+
+#include <deque>
+
+#include "logstore.h"
+
+/**
+ * @brief Table model of the entries of a LogStore that match a filter.
+ *
+ * Columns: time, source, message. Only used from the GUI thread.
+ */
+class LogPanelModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { TimeColumn, SourceColumn, MessageColumn, NbColumns };
+
+    /**
+     * @param _maxRows Number of entries retained by the store.
+     * @param _spillPath File receiving the evicted entries (see LogStore).
+     * @param _parent Parent object.
+     */
+    LogPanelModel(size_t _maxRows, const QString& _spillPath, QObject* _parent = nullptr);
+
+    int rowCount(const QModelIndex& _parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& _parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& _index, int _role = Qt::DisplayRole) const override;
+    QVariant headerData(int _section, Qt::Orientation _orientation, int _role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Appends an entry; the view sees it at the next publication.
+     */
+    void append(const LogRecord& _record, const QString& _text = QString());
+
+    /**
+     * @brief Keeps only the entries of a source whose message contains a text.
+     *
+     * @param _entity Source kept, or -1 for all of them.
+     * @param _search Text searched, case-insensitive; empty to keep all messages.
+     */
+    void setFilter(long _entity, const QString& _search);
+
+private:
+    /**
+     * @brief Répercute sur la vue les entrées ajoutées et retirées depuis la dernière publication.
+     */
+    void publish();
+
+    bool matches(std::uint64_t _seq) const;
+
+    LogStore m_store;
+
+    /**
+     * @brief Numéros des entrées retenues par le filtre, dans l'ordre.
+     */
+    std::deque<std::uint64_t> m_rows;
+
+    /**
+     * @brief Fin du journal à la dernière publication.
+     */
+    std::uint64_t m_published = 0;
+
+    long m_entity = -1;
+    QString m_search;
+
+    QTimer m_publishTimer;
+};
+
+/**
+ * @brief Widget of the log: source filter, search field and virtualized table.
+ */
+class LogPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param _maxEntity Largest source id (number of people).
+     * @param _parent Parent widget.
+     */
+    LogPanel(unsigned int _maxEntity, QWidget* _parent = nullptr);
+
+    /**
+     * @brief Appends an entry to the log.
+     */
+    void append(const LogRecord& _record, const QString& _text = QString());
+
+private slots:
+    void applyFilter();
+
+private:
+    LogPanelModel* m_model;
+    QTableView* m_view;
+    QSpinBox* m_source;
+    QLineEdit* m_search;
+
+    /**
+     * @brief Délai avant d'appliquer une recherche, le temps de finir de taper.
+     */
+    QTimer m_searchDelay;
+
+    /**
+     * @brief Vue en bas du journal avant une insertion : elle suit alors les nouvelles lignes.
+     */
+    bool m_follow = true;
+};
+
+#endif // LOGPANEL_H
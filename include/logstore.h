@@ -0,0 +1,113 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : logstore.h
+ * Stockage en colonnes du journal de la simulation : une colonne par champ (source, date, message,
+ * arguments) dans un anneau de taille fixe, les textes libres à part. Une entrée n'est mise en
+ * forme qu'à la demande, pour les lignes affichées ou pour une recherche. Lorsque l'anneau est
+ * plein, les entrées les plus anciennes sont retirées par paquets et écrites, mises en forme,
+ * dans un fichier de débordement.
+ */
+
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "logmessage.h"
+
+/**
+ * @brief Bounded columnar store of log entries.
+ *
+ * Entries are numbered by a sequence number that never wraps; the store
+ * keeps those in [begin(), end()). Only used from the GUI thread.
+ */
+class LogStore
+{
+public:
+    /**
+     * @param _maxRows Number of entries retained (at least 1).
+     * @param _spillPath File receiving the evicted entries, truncated at the
+     *        first eviction; empty to discard them.
+     */
+    LogStore(size_t _maxRows, const QString& _spillPath);
+
+    LogStore(const LogStore&) = delete;
+    LogStore& operator=(const LogStore&) = delete;
+
+    /**
+     * @brief Appends an entry, evicting the oldest ones if the store is full.
+     *
+     * @param _record Entry to append.
+     * @param _text Text of a LogMessage::Text entry.
+     * @return Sequence number of the entry.
+     */
+    std::uint64_t append(const LogRecord& _record, const QString& _text = QString());
+
+    std::uint64_t begin() const { return m_begin; }
+    std::uint64_t end() const { return m_end; }
+
+    /**
+     * @brief Columns of a retained entry.
+     */
+    std::uint32_t entity(std::uint64_t _seq) const { return m_entity[slot(_seq)]; }
+    std::uint64_t timeMs(std::uint64_t _seq) const { return m_timeMs[slot(_seq)]; }
+
+    /**
+     * @brief Formats the message of a retained entry.
+     */
+    QString message(std::uint64_t _seq) const;
+
+    /**
+     * @brief Formats a message from its identifier and arguments.
+     */
+    static QString format(LogMessage _message, const std::int64_t* _args, const QString& _text);
+
+    /**
+     * @brief Formats the source of an entry.
+     */
+    static QString source(std::uint32_t _entity);
+
+    /**
+     * @brief Formats a simulated time.
+     */
+    static QString time(std::uint64_t _timeMs);
+
+private:
+    size_t slot(std::uint64_t _seq) const { return static_cast<size_t>(_seq % m_capacity); }
+
+    /**
+     * @brief Retire les @p _count entrées les plus anciennes et les écrit dans le fichier de débordement.
+     */
+    void evict(size_t _count);
+
+    const size_t m_capacity;
+
+    // COLONNES (case d'une entrée : numéro de séquence modulo la capacité)
+
+    std::vector<std::uint32_t> m_entity;
+    std::vector<std::uint64_t> m_timeMs;
+    std::vector<LogMessage> m_message;
+    std::vector<std::int64_t> m_args;
+
+    /**
+     * @brief Textes libres, dans l'ordre des entrées LogMessage::Text (leur premier argument
+     *        est le numéro du texte).
+     */
+    std::deque<QString> m_texts;
+    std::uint64_t m_firstText = 0;
+
+    std::uint64_t m_begin = 0;
+    std::uint64_t m_end = 0;
+
+    QFile m_spill;
+};
+
+#endif // LOGSTORE_H
@@ -10,9 +10,12 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTextEdit>
 #include <QDockWidget>
+#include <QAction>
+#include <thread>
 #include "display.h"
+#include "logpanel.h"
+#include "occupancydashboard.h"
 
 #include "config.h"
 #include "bikestation.h"
@@ -29,24 +32,34 @@ public:
                QWidget *parent = 0);
     ~MainWindow();
 
-    QDockWidget **m_docks;
-    QTextEdit **m_consoles;
+    QDockWidget *m_logDock;
+    LogPanel *m_logPanel;
     BikeDisplay *m_display;
-
-    void setConsoleTitle(unsigned int consoleId,QString title);
+    QDockWidget *m_occupancyDock;
+    OccupancyDashboard *m_occupancy;
 
 protected:
     unsigned int m_nbConsoles;
     bool m_stopped{false};
 
+    QAction *m_plusDepot;
+    QAction *m_minusDepot;
+    QAction *m_checkpointAction;
+    //! Sauvegarde en cours, hors du thread graphique
+    std::thread m_checkpointThread;
+
 private slots:
     void onStopClicked();
     void onDepotPlusClicked();
     void onDepotMinusClicked();
+    void onCheckpointClicked();
+    void onCheckpointDone(bool ok);
+    void onLatencyClicked();
     void onEndClicked();
 
 public slots:
     void consoleAppendText(unsigned int consoleId,QString text);
+    void appendLog(const LogRecord &record,const QString &text);
     void setBikes(unsigned int site,unsigned int nbBike);
     void setPerson(unsigned int site, unsigned int personID);
     void travel(unsigned int personId,unsigned int site1, unsigned int site2,unsigned int ms);
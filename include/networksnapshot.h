@@ -0,0 +1,47 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : networksnapshot.h
+ * Vue des compteurs de toutes les stations (sites et dépôt) obtenue sans prendre
+ * les verrous des stations, utilisée pour planifier les tournées du van et pour l'affichage.
+ */
+
+#ifndef NETWORKSNAPSHOT_H
+#define NETWORKSNAPSHOT_H
+
+#include <array>
+#include "config.h"
+#include "bikestation.h"
+
+/**
+ * @brief Immutable per-station, per-type counts of the whole network.
+ *
+ * Index @ref DEPOT_ID holds the depot.
+ */
+using NetworkSnapshot = std::array<StationCounts, NB_SITES_TOTAL>;
+
+/**
+ * @brief Reads the counts of every station without blocking them.
+ *
+ * Each entry never shows a mutation made under the station mutex half done;
+ * single-count rentals and returns of the lock-free path may land during the
+ * read (see BikeStation::snapshot()). Stations are read one after the other,
+ * so the snapshot as a whole reflects the network over the few microseconds
+ * needed to read it.
+ *
+ * @param _stations Array of pointers to all stations (sites + depot).
+ * @return Counts of every station; missing stations are reported empty.
+ */
+inline NetworkSnapshot takeNetworkSnapshot(const std::array<BikeStation*, NB_SITES_TOTAL>& _stations)
+{
+    NetworkSnapshot snapshot{};
+    for (size_t s = 0; s < NB_SITES_TOTAL; ++s) {
+        if (_stations[s])
+            snapshot[s] = _stations[s]->snapshot();
+    }
+    return snapshot;
+}
+
+#endif // NETWORKSNAPSHOT_H
@@ -0,0 +1,68 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : occupancydashboard.h
+ * Tableau de bord de l'occupation des sites, à côté de la carte de BikeDisplay : une carte de
+ * chaleur (un site par ligne, une colonne de l'historique par colonne) et deux courbes des minutes
+ * de sites vides et de sites pleins. Il échantillonne lui-même les stations sans verrou et ne se
+ * redessine qu'à chaque colonne terminée : son coût ne dépend pas du trafic.
+ */
+
+#ifndef OCCUPANCYDASHBOARD_H
+#define OCCUPANCYDASHBOARD_H
+
+#include <QTimer>
+#include <QWidget>
+
+#include <memory>
+
+#include "occupancyhistory.h"
+
+class QPainter;
+
+/**
+ * @brief Heatmap and sparklines of the occupancy of the sites over time.
+ */
+class OccupancyDashboard : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param _nbSites Number of sites shown (the depot is left out).
+     * @param _parent Parent widget.
+     */
+    explicit OccupancyDashboard(unsigned int _nbSites, QWidget* _parent = nullptr);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* _event) override;
+
+private slots:
+    /**
+     * @brief Prend un instantané des stations et redessine si une colonne est terminée.
+     */
+    void poll();
+
+private:
+    /**
+     * @brief Dessine la courbe des minutes de sites vides ou pleins par colonne.
+     */
+    void paintSparkline(QPainter& _painter, const QRect& _area, bool _full,
+                        const QColor& _color, const QString& _label) const;
+
+    const unsigned int m_nbSites;
+
+    /**
+     * @brief Créé au premier échantillon, quand les stations existent.
+     */
+    std::unique_ptr<OccupancyHistory> m_history;
+
+    unsigned long long m_paintedVersion = 0;
+    QTimer m_pollTimer;
+};
+
+#endif // OCCUPANCYDASHBOARD_H
@@ -0,0 +1,117 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : occupancyhistory.h
+ * Historique sous-échantillonné de l'occupation des sites : des instantanés du réseau sont pris à
+ * intervalle régulier et cumulés dans la colonne courante (occupation moyenne de chaque site,
+ * minutes de site vide et de site plein). Une colonne couvre une durée simulée fixe ; les colonnes
+ * terminées sont rangées dans un anneau de taille fixe. La taille de l'historique ne dépend donc
+ * que du nombre de sites et de colonnes, pas du trafic.
+ */
+
+#ifndef OCCUPANCYHISTORY_H
+#define OCCUPANCYHISTORY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "networksnapshot.h"
+
+/**
+ * @brief Ring of down-sampled occupancy columns of the sites.
+ */
+class OccupancyHistory
+{
+public:
+    /**
+     * @brief Aggregates of one column, over all sites.
+     */
+    struct Column
+    {
+        std::uint64_t startMs = 0;
+
+        /**
+         * @brief Sum over the sites of the simulated minutes spent without any bike.
+         */
+        double emptyMinutes = 0;
+
+        /**
+         * @brief Sum over the sites of the simulated minutes spent without any free dock.
+         *
+         * A reserved dock is not free: a site is full once its bikes and its
+         * reserved docks fill its capacity.
+         */
+        double fullMinutes = 0;
+    };
+
+    /**
+     * @param _capacities Number of docks of each site (site s at index s).
+     * @param _nbColumns Number of columns retained.
+     * @param _columnMs Simulated duration covered by a column.
+     */
+    OccupancyHistory(std::vector<size_t> _capacities, size_t _nbColumns, std::uint64_t _columnMs);
+
+    /**
+     * @brief Accounts for a snapshot of the network taken at a simulated time.
+     *
+     * The counts seen are held since the previous sample. Closes the
+     * current column once its duration is over.
+     */
+    void sample(std::uint64_t _timeMs, const NetworkSnapshot& _view);
+
+    size_t nbSites() const { return m_capacities.size(); }
+
+    /**
+     * @brief Number of completed columns retained (at most the ring size).
+     */
+    size_t nbColumns() const { return m_count; }
+
+    size_t maxColumns() const { return m_columns.size(); }
+
+    /**
+     * @brief Completed column, 0 being the oldest retained.
+     */
+    const Column& column(size_t _i) const { return m_columns[index(_i)]; }
+
+    /**
+     * @brief Mean fraction of the docks of a site holding a bike during a column (0 to 1).
+     */
+    float occupancy(size_t _i, size_t _site) const { return m_occupancy[index(_i) * nbSites() + _site]; }
+
+    /**
+     * @brief Incremented each time a column is completed.
+     */
+    unsigned long long version() const { return m_version; }
+
+private:
+    size_t index(size_t _i) const { return (m_first + _i) % m_columns.size(); }
+
+    /**
+     * @brief Range la colonne courante dans l'anneau et en commence une nouvelle.
+     */
+    void closeColumn(std::uint64_t _nextStartMs);
+
+    const std::vector<size_t> m_capacities;
+    const std::uint64_t m_columnMs;
+
+    // ANNEAU DES COLONNES TERMINÉES
+
+    std::vector<Column> m_columns;
+    std::vector<float> m_occupancy;
+    size_t m_first = 0;
+    size_t m_count = 0;
+    unsigned long long m_version = 0;
+
+    // COLONNE COURANTE
+
+    bool m_started = false;
+    std::uint64_t m_lastMs = 0;
+    Column m_current;
+    std::vector<double> m_occupancySum;
+    std::vector<float> m_lastOccupancy;
+    double m_weightMs = 0;
+};
+
+#endif // OCCUPANCYHISTORY_H
@@ -15,9 +15,13 @@
 #define PERSON_H
 
 #include <array>
+#include <optional>
 #include "config.h"
 #include "bikestation.h"
-#include "bikinginterface.h"
+#include "simulationview.h"
+#include "sitemap.h"
+#include "demandmodel.h"
+#include "checkpoint.h"
 
 /**
  * @brief Simulates an person using the bike-sharing system.
@@ -54,7 +58,7 @@ public:
      *
      * @param _binkingInterface Pointer to the interface implementation.
      */
-    static void setInterface(BikingInterface* _binkingInterface);
+    static void setInterface(SimulationView* _binkingInterface);
 
     /**
      * @brief Sets the array of bike stations used by all people.
@@ -63,34 +67,103 @@ public:
      */
     static void setStations(const std::array<BikeStation*, NB_SITES_TOTAL>& _stations);
 
+    /**
+     * @brief Sets the spatial model used for destinations and travel times.
+     *
+     * @param _siteMap Site map shared by all people (may be null, in which
+     *        case destinations and travel times are uniformly random).
+     */
+    static void setSiteMap(const SiteMap* _siteMap);
+
+    /**
+     * @brief Sets the origin-destination demand used to choose destinations.
+     *
+     * @param _demandModel Demand model shared by all people (may be null, in
+     *        which case destinations are drawn among the nearest sites).
+     */
+    static void setDemandModel(const DemandModel* _demandModel);
+
+    /**
+     * @brief Restores the state saved in a checkpoint.
+     *
+     * Must be called before run(). A bike held when the checkpoint was
+     * taken is deposited at the saved site before the first trip.
+     *
+     * @param _state Saved state of this person.
+     * @param _bike Bike held by the person (may be null).
+     */
+    void restore(const AgentState& _state, Bike* _bike);
+
 private:
+    /**
+     * @brief Builds the state published for checkpoints.
+     *
+     * @param _site Site where the person is, or is heading to.
+     * @param _bike Bike held by the person (may be null).
+     * @return State of the person (valid until the next call).
+     */
+    const AgentState& agentState(unsigned int _site, Bike* _bike);
+
     /**
      * @brief Chooses a random site different from the given one.
      *
+     * The site is drawn from the demand of the current time-of-day profile
+     * if a demand model is set, among the nearest neighbours of @p _from
+     * otherwise.
+     *
      * @param _from Origin site index.
      * @return Index of a different site.
      */
     unsigned int chooseOtherSite(unsigned int _from) const;
 
     /**
-     * @brief Computes a random travel time for a bike trip.
+     * @brief Chooses the destination of a bike trip and reserves a dock there.
+     *
+     * Up to @ref RESERVATION_ATTEMPTS destinations are tried. If none has a
+     * free dock, the first one is kept and @ref dockReservation stays invalid.
+     *
+     * @return Destination site index.
+     */
+    unsigned int chooseDestination();
+
+    /**
+     * @brief Chooses where to go when a site refuses a request because it is overloaded.
+     *
+     * The nearest neighbours of the overloaded site are tried in order of
+     * distance (a random site if there is no site map).
+     *
+     * @param _site Overloaded site index.
+     * @param _attempt Number of redirections already made from this site.
+     * @return Index of the site to try next.
+     */
+    unsigned int redirectSite(unsigned int _site, size_t _attempt) const;
+
+    /**
+     * @brief Computes the travel time for a bike trip.
      *
+     * @param _from Origin site index.
+     * @param _to Destination site index.
      * @return Travel time in milliseconds.
      */
-    unsigned int bikeTravelTime() const;
+    unsigned int bikeTravelTime(unsigned int _from, unsigned int _to) const;
 
     /**
-     * @brief Computes a random travel time for a walk.
+     * @brief Computes the travel time for a walk.
      *
      * Typically longer than a bike trip.
      *
+     * @param _from Origin site index.
+     * @param _to Destination site index.
      * @return Travel time in milliseconds.
      */
-    unsigned int walkTravelTime() const;
+    unsigned int walkTravelTime(unsigned int _from, unsigned int _to) const;
 
     /**
      * @brief Takes a bike of the preferred type from the given site.
      *
+     * Uses the bike reserved while walking to the site, if any. If the site
+     * is overloaded, walks to the next-nearest site and tries again there;
+     * after @ref SiteMap::nbNeighbours redirections, waits wherever it is.
      * Updates the user interface with the new bike count at the site.
      *
      * @param _site Index of the site from which to take the bike.
@@ -101,6 +174,9 @@ private:
     /**
      * @brief Deposits a bike at the given site.
      *
+     * Uses the dock reserved when the trip started, if any. If the site is
+     * overloaded, rides to the next-nearest site and tries again there;
+     * after @ref SiteMap::nbNeighbours redirections, waits wherever it is.
      * Updates the user interface with the new bike count at the site.
      *
      * @param _site Index of the site where the bike is deposited.
@@ -128,11 +204,14 @@ private:
     void walkTo(unsigned int _dest);
 
     /**
-     * @brief Writes a message to the user interface console if available.
+     * @brief Adds an entry of this person to the user interface log if available.
      *
-     * @param _msg Message to log.
+     * @param _message Message identifier.
+     * @param _arg0 First argument of the message (see LogMessage).
+     * @param _arg1 Second argument of the message.
+     * @param _arg2 Third argument of the message.
      */
-    void log(const QString& _msg) const;
+    void log(LogMessage _message, long long _arg0 = 0, long long _arg1 = 0, long long _arg2 = 0) const;
 
     /**
      * @brief Unique identifier of the person.
@@ -156,15 +235,55 @@ private:
      */
     unsigned int currentSite;
 
+    /**
+     * @brief Bike reserved at the site the person is walking to.
+     */
+    Reservation bikeReservation;
+
+    /**
+     * @brief Dock reserved at the destination of the current bike trip.
+     */
+    Reservation dockReservation;
+
+    /**
+     * @brief Slot where the person publishes its state for checkpoints.
+     */
+    Checkpoint::Slot* checkpointSlot = nullptr;
+
+    /**
+     * @brief State rebuilt in place by agentState().
+     */
+    AgentState publishedState;
+
+    /**
+     * @brief Bike held when the restored checkpoint was taken.
+     */
+    Bike* restoredBike = nullptr;
+
+    /**
+     * @brief Random generator state to resume with, if restored.
+     */
+    std::optional<FastRng::State> restoredRng;
+
     /**
      * @brief User interface shared by all people (may be null).
      */
-    static BikingInterface* binkingInterface;
+    static SimulationView* binkingInterface;
 
     /**
      * @brief Shared array of bike stations for all sites and the depot.
      */
     static std::array<BikeStation*, NB_SITES_TOTAL> stations;
+
+    /**
+     * @brief Spatial model shared by all people (may be null).
+     */
+    static const SiteMap* siteMap;
+
+    /**
+     * @brief Origin-destination demand shared by all people (may be null).
+     */
+    static const DemandModel* demandModel;
 };
 
 #endif // PERSON_H
@@ -0,0 +1,33 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : shutdown.h
+ * Arrêt de la simulation, commun à l'application, au lanceur de balayages et aux tests : demande
+ * d'arrêt à chaque thread, puis réveil de tous les threads bloqués (stations et roue temporelle).
+ */
+
+#ifndef SHUTDOWN_H
+#define SHUTDOWN_H
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <pcosynchro/pcothread.h>
+
+#include "bikestation.h"
+#include "config.h"
+
+/**
+ * @brief Stops every thread of the simulation and releases the blocked ones.
+ *
+ * The stops are requested before anyone is woken, so that a woken agent
+ * sees the request instead of starting another step. Null entries are
+ * skipped. Returns at once; the caller joins the threads.
+ */
+void requestShutdown(std::vector<std::unique_ptr<PcoThread>>& _threads,
+                     const std::array<BikeStation*, NB_SITES_TOTAL>& _stations);
+
+#endif // SHUTDOWN_H
@@ -0,0 +1,147 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : simstats.h
+ * Compteurs agrégés d'une simulation : attentes des personnes aux stations (location et dépôt),
+ * demandes non servies immédiatement, profondeur des files d'attente des sites et activité du van. Utilisés par le lanceur de balayages
+ * de paramètres (sweep) pour comparer des configurations.
+ */
+
+#ifndef SIMSTATS_H
+#define SIMSTATS_H
+
+#include <atomic>
+
+#include "bikestation.h"
+
+/**
+ * @brief Aggregated counters of a simulation run.
+ *
+ * Durations are in simulated milliseconds. A request is counted as
+ * unserved when the person had to wait at least one timer tick, i.e. no
+ * bike (or no dock) was available on arrival. A request refused by
+ * admission control is counted as overloaded; the person then retries
+ * elsewhere, so the eventual rental or return is also counted.
+ */
+class SimStats
+{
+public:
+    /**
+     * @brief Copy of the counters at a given time.
+     */
+    struct Summary
+    {
+        unsigned long long rentals = 0;
+        unsigned long long rentWaitMs = 0;
+        unsigned long long rentWaitMaxMs = 0;
+        unsigned long long unservedRentals = 0;
+
+        unsigned long long returns = 0;
+        unsigned long long returnWaitMs = 0;
+        unsigned long long returnWaitMaxMs = 0;
+        unsigned long long unservedReturns = 0;
+
+        unsigned long long overloadedRentals = 0;
+        unsigned long long overloadedReturns = 0;
+
+        /**
+         * @brief Number of station samples of the waiting queues (one per site per sample).
+         */
+        unsigned long long queueSamples = 0;
+        unsigned long long waitingRidersSum = 0;
+        unsigned long long waitingRidersMax = 0;
+        unsigned long long waitingDepositorsSum = 0;
+        unsigned long long waitingDepositorsMax = 0;
+
+        unsigned long long vanBusyMs = 0;
+        unsigned long long vanIdleMs = 0;
+        unsigned long long vanBikesMoved = 0;
+    };
+
+    /**
+     * @brief Returns the counters shared by the simulation.
+     */
+    static SimStats& instance();
+
+    /**
+     * @brief Records a bike taken by a person.
+     *
+     * @param _waitMs Time spent waiting for the bike.
+     */
+    void recordRental(unsigned long long _waitMs);
+
+    /**
+     * @brief Records a bike returned by a person.
+     *
+     * @param _waitMs Time spent waiting for a dock.
+     */
+    void recordReturn(unsigned long long _waitMs);
+
+    /**
+     * @brief Records a rental refused because the station was overloaded.
+     */
+    void recordOverloadedRental();
+
+    /**
+     * @brief Records a return refused because the station was overloaded.
+     */
+    void recordOverloadedReturn();
+
+    /**
+     * @brief Records the depth of the waiting queues of one site at one instant.
+     *
+     * Meant to be called for every site at a regular simulated interval, so
+     * that the sums divided by @ref Summary::queueSamples are the mean depth
+     * of the queue of a site over time.
+     *
+     * @param _counts Counts of the site (see BikeStation::snapshot()).
+     */
+    void recordQueueDepth(const StationCounts& _counts);
+
+    /**
+     * @brief Records one tour of a van.
+     *
+     * @param _busyMs Time spent loading, driving and balancing.
+     * @param _idleMs Time spent pausing at the depot.
+     * @param _bikesMoved Bikes loaded or unloaded during the tour.
+     */
+    void recordVanTour(unsigned long long _busyMs, unsigned long long _idleMs,
+                       unsigned long long _bikesMoved);
+
+    /**
+     * @brief Returns a copy of the counters.
+     */
+    Summary summary() const;
+
+private:
+    SimStats() = default;
+
+    static void raiseMax(std::atomic<unsigned long long>& _max, unsigned long long _value);
+
+    std::atomic<unsigned long long> rentals{0};
+    std::atomic<unsigned long long> rentWaitMs{0};
+    std::atomic<unsigned long long> rentWaitMaxMs{0};
+    std::atomic<unsigned long long> unservedRentals{0};
+
+    std::atomic<unsigned long long> returns{0};
+    std::atomic<unsigned long long> returnWaitMs{0};
+    std::atomic<unsigned long long> returnWaitMaxMs{0};
+    std::atomic<unsigned long long> unservedReturns{0};
+
+    std::atomic<unsigned long long> overloadedRentals{0};
+    std::atomic<unsigned long long> overloadedReturns{0};
+
+    std::atomic<unsigned long long> queueSamples{0};
+    std::atomic<unsigned long long> waitingRidersSum{0};
+    std::atomic<unsigned long long> waitingRidersMax{0};
+    std::atomic<unsigned long long> waitingDepositorsSum{0};
+    std::atomic<unsigned long long> waitingDepositorsMax{0};
+
+    std::atomic<unsigned long long> vanBusyMs{0};
+    std::atomic<unsigned long long> vanIdleMs{0};
+    std::atomic<unsigned long long> vanBikesMoved{0};
+};
+
+#endif // SIMSTATS_H
@@ -0,0 +1,56 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : simulationview.h
+ * Ce que les agents (Person, Van) voient de l'affichage : le journal, le nombre de vélos des sites
+ * et les déplacements. BikingInterface l'implémente pour l'application graphique ; le cœur de la
+ * simulation ne dépend ainsi pas de Qt et peut tourner sans interface (pco_sweep, tests).
+ */
+
+#ifndef SIMULATIONVIEW_H
+#define SIMULATIONVIEW_H
+
+#include "logmessage.h"
+
+/**
+ * @brief Display of the simulation, as used by the agent threads.
+ *
+ * Every method may be called concurrently by several agent threads.
+ */
+class SimulationView
+{
+public:
+    virtual ~SimulationView() = default;
+
+    /**
+     * @brief Adds a log entry attributed to a source (0: system and van, n: person n).
+     */
+    virtual void log(unsigned int _entityId, LogMessage _message,
+                     long long _arg0 = 0, long long _arg1 = 0, long long _arg2 = 0) = 0;
+
+    /**
+     * @brief Shows the number of bikes at a site (DEPOT_ID for the depot).
+     */
+    virtual void setBikes(unsigned int _site, unsigned int _nbBikes) = 0;
+
+    /**
+     * @brief Shows a person riding between two sites; returns once the ride is over.
+     *
+     * @param _ms Simulated duration of the ride.
+     */
+    virtual void travel(unsigned int _personId, unsigned int _site1, unsigned int _site2, unsigned int _ms) = 0;
+
+    /**
+     * @brief Shows a person walking between two sites; returns once the walk is over.
+     */
+    virtual void walk(unsigned int _personId, unsigned int _site1, unsigned int _site2, unsigned int _ms) = 0;
+
+    /**
+     * @brief Shows the van driving between two sites; returns once the trip is over.
+     */
+    virtual void vanTravel(unsigned int _site1, unsigned int _site2, unsigned int _ms) = 0;
+};
+
+#endif // SIMULATIONVIEW_H
@@ -0,0 +1,121 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : sitemap.h
+ * Cette classe représente la géographie du réseau : coordonnées des sites et du dépôt,
+ * chargées depuis un fichier ou disposées en cercle par défaut.
+ * Elle précalcule une matrice des distances et des temps de trajet (stockage contigu)
+ * ainsi que la liste des plus proches voisins de chaque site.
+ */
+
+#ifndef SITEMAP_H
+#define SITEMAP_H
+
+#include <array>
+#include <string>
+#include "config.h"
+
+/**
+ * @brief Spatial model of the network with precomputed distances.
+ *
+ * Distances and travel times are stored in flat row-major matrices so that
+ * a lookup is a single indexed load. Each regular site also keeps the list of
+ * its @ref SITE_NEIGHBOURS nearest regular sites, sorted by distance.
+ *
+ * Once built, a SiteMap is read-only and can be shared by all threads.
+ */
+class SiteMap
+{
+public:
+    /**
+     * @brief Builds the default layout: sites on a circle, depot at the center.
+     */
+    SiteMap();
+
+    /**
+     * @brief Loads site coordinates from a file and recomputes the matrices.
+     *
+     * The file contains one "x y" line per site, the depot last. Empty lines
+     * and lines starting with '#' are ignored. If the file cannot be read or
+     * does not describe all the sites, the current layout is kept.
+     *
+     * @param _path Path of the file to read.
+     * @return true if the layout has been loaded from the file.
+     */
+    bool loadFromFile(const std::string& _path);
+
+    /**
+     * @brief Returns the x coordinate of a site.
+     *
+     * @param _site Site index (the depot is @ref DEPOT_ID).
+     */
+    double x(unsigned int _site) const { return xs[_site]; }
+
+    /**
+     * @brief Returns the y coordinate of a site.
+     *
+     * @param _site Site index (the depot is @ref DEPOT_ID).
+     */
+    double y(unsigned int _site) const { return ys[_site]; }
+
+    /**
+     * @brief Returns the distance between two sites.
+     */
+    float distance(unsigned int _from, unsigned int _to) const
+    {
+        return distances[_from * NB_SITES_TOTAL + _to];
+    }
+
+    /**
+     * @brief Returns the travel time between two sites, in milliseconds.
+     */
+    unsigned int travelTimeMs(unsigned int _from, unsigned int _to) const
+    {
+        return travelTimes[_from * NB_SITES_TOTAL + _to];
+    }
+
+    /**
+     * @brief Number of entries in each nearest-neighbour list.
+     */
+    static constexpr size_t nbNeighbours =
+            SITE_NEIGHBOURS < NBSITES - 1 ? SITE_NEIGHBOURS : NBSITES - 1;
+
+    /**
+     * @brief Returns the nearest regular sites of a regular site.
+     *
+     * @param _site Regular site index (0..NBSITES-1).
+     * @return Site indices sorted by increasing distance, @p _site excluded.
+     */
+    const std::array<unsigned int, nbNeighbours>& nearest(unsigned int _site) const
+    {
+        return neighbours[_site];
+    }
+
+private:
+    /**
+     * @brief Recomputes the distance, travel time and neighbour tables.
+     */
+    void computeMatrices();
+
+    std::array<double, NB_SITES_TOTAL> xs{};
+    std::array<double, NB_SITES_TOTAL> ys{};
+
+    /**
+     * @brief Matrice des distances (ligne = départ, colonne = arrivée).
+     */
+    std::array<float, NB_SITES_TOTAL * NB_SITES_TOTAL> distances{};
+
+    /**
+     * @brief Matrice des temps de trajet en millisecondes.
+     */
+    std::array<unsigned int, NB_SITES_TOTAL * NB_SITES_TOTAL> travelTimes{};
+
+    /**
+     * @brief Plus proches voisins de chaque site régulier.
+     */
+    std::array<std::array<unsigned int, nbNeighbours>, NBSITES> neighbours{};
+};
+
+#endif // SITEMAP_H
@@ -0,0 +1,214 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : stationlog.h
+ * Journal des mutations d'une station : chaque dépôt, retrait ou opération groupée y est ajouté
+ * sous la forme d'un événement de 8 octets (date simulée, genre, compteur touché, variation).
+ * L'ajout est un simple incrément atomique du pointeur d'écriture suivi de deux écritures, sans
+ * verrou, pour rester compatible avec le chemin rapide des stations. Le journal est un anneau :
+ * la compaction intègre périodiquement les événements dans un état courant (comptes et intégrales
+ * d'utilisation) et garde un historique d'instantanés, à partir duquel un état passé est
+ * reconstruit en rejouant les événements encore présents dans l'anneau.
+ */
+
+#ifndef STATIONLOG_H
+#define STATIONLOG_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <pcosynchro/pcomutex.h>
+
+#include "bike.h"
+
+/**
+ * @brief Event-sourced log of the bike counts of one station.
+ *
+ * The state tracked is one counter per bike type (bikes available to
+ * riders), one for the bikes waiting for maintenance and one for the bikes
+ * held by reservations: their sum is the number of occupied docks.
+ *
+ * Every deposit is logged before the removal of the same bike, and every
+ * removal before the deposit in the dock it freed (see
+ * BikeStation::record()): every prefix of the log is a state the station
+ * went through. Utilisation integrals start at the first event of the
+ * station and are exact to the simulated millisecond, except when a thread
+ * is descheduled between reserving its slot in the log and reading the
+ * clock: an event dated before the previous one is then counted from the
+ * date of the previous one.
+ */
+class StationLog
+{
+public:
+    /**
+     * @brief Mutation recorded by an event.
+     */
+    enum Kind : unsigned int { Put = 1, Get, AddBikes, RemoveBikes, Reserve, Release };
+
+    static constexpr unsigned int maintenanceCounter = Bike::nbBikeTypes;
+    static constexpr unsigned int reservedCounter = Bike::nbBikeTypes + 1;
+    static constexpr unsigned int nbCounters = Bike::nbBikeTypes + 2;
+
+    using Counts = std::array<long, nbCounters>;
+
+    /**
+     * @brief Decoded event.
+     */
+    struct Event
+    {
+        std::uint64_t timeMs;
+        Kind kind;
+        unsigned int counter;
+        int delta;
+    };
+
+    /**
+     * @brief Counts of the station at a given time.
+     */
+    struct State
+    {
+        std::uint64_t timeMs = 0;
+        Counts counts{};
+
+        /**
+         * @brief false if the events needed were already overwritten: the
+         *        state is then the one of the closest snapshot.
+         */
+        bool exact = true;
+
+        /**
+         * @brief Number of occupied docks.
+         */
+        long nbBikes() const;
+    };
+
+    /**
+     * @brief Utilisation integrals since the first event, in simulated milliseconds.
+     */
+    struct Utilisation
+    {
+        std::uint64_t sinceMs = 0;
+        std::uint64_t untilMs = 0;
+
+        /**
+         * @brief Integral of the number of occupied docks (bike-ms docked).
+         */
+        std::uint64_t bikeMs = 0;
+
+        /**
+         * @brief Integral of the number of docks without a bike (dock-ms empty).
+         */
+        std::uint64_t emptyDockMs = 0;
+
+        double bikeMinutes() const { return bikeMs / 60000.0; }
+        double emptyDockMinutes() const { return emptyDockMs / 60000.0; }
+    };
+
+    /**
+     * @param _capacity Number of docks of the station.
+     * @param _nbEvents Size of the ring, rounded up to a power of two.
+     * @param _nbSnapshots Number of snapshots kept for reconstruction.
+     */
+    StationLog(size_t _capacity, size_t _nbEvents, size_t _nbSnapshots);
+
+    StationLog(const StationLog&) = delete;
+    StationLog& operator=(const StationLog&) = delete;
+
+    /**
+     * @brief Appends an event dated now; lock-free, callable from any thread.
+     *
+     * The date is read once the slot of the event is reserved.
+     *
+     * Only blocks if the ring is full of events not compacted yet, the
+     * time for the caller to compact it.
+     *
+     * @param _kind Mutation recorded.
+     * @param _counter Counter changed (bike type, maintenanceCounter or reservedCounter).
+     * @param _delta Change of the counter.
+     */
+    void append(Kind _kind, unsigned int _counter, long _delta);
+
+    /**
+     * @brief Folds every event fully written into the current state and takes a snapshot.
+     */
+    void compact();
+
+    /**
+     * @brief Returns the utilisation integrals up to now.
+     */
+    Utilisation utilisation();
+
+    /**
+     * @brief Reconstructs the counts of the station at a past time.
+     *
+     * Exact as long as the events since the closest older snapshot are
+     * still in the ring; see State::exact.
+     *
+     * @param _timeMs Simulated time.
+     */
+    State stateAt(std::uint64_t _timeMs);
+
+private:
+    /**
+     * @brief Case de l'anneau, protégée par son propre numéro de séquence (impair pendant l'écriture).
+     */
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<std::uint64_t> payload{0};
+    };
+
+    struct Snapshot
+    {
+        std::uint64_t index;
+        std::uint64_t timeMs;
+        Counts counts;
+    };
+
+    static std::uint64_t encode(std::uint64_t _timeMs, Kind _kind, unsigned int _counter, int _delta);
+    static Event decode(std::uint64_t _payload);
+
+    /**
+     * @brief Reads the event of a given index if it is fully written and not overwritten.
+     */
+    bool read(std::uint64_t _index, Event& _event) const;
+
+    void tryCompact();
+
+    /**
+     * @brief Compaction ; le mutex doit être pris.
+     */
+    void compactLocked();
+
+    /**
+     * @brief Advances the integrals to a given time; the mutex must be held.
+     */
+    void integrateTo(std::uint64_t _timeMs);
+
+    const long capacity;
+    std::unique_ptr<Slot[]> ring;
+    std::uint64_t mask;
+
+    /**
+     * @brief Index du prochain événement à écrire et du premier non compacté.
+     */
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    alignas(64) std::atomic<std::uint64_t> folded{0};
+
+    // ÉTAT COMPACTÉ (sous le mutex)
+
+    PcoMutex mutex;
+    Counts counts{};
+    bool started = false;
+    Utilisation integrals;
+
+    std::vector<Snapshot> snapshots;
+    size_t nextSnapshot = 0;
+};
+
+#endif // STATIONLOG_H
@@ -0,0 +1,239 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : timerwheel.h
+ * Roue temporelle hiérarchique partagée par la simulation. Elle porte l'horloge simulée
+ * (temps réel ou accéléré) et planifie tous les réveils : trajets des personnes, pauses du van
+ * et expiration des réservations des stations. Un thread dédié avance la roue d'un cran à chaque tick.
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <pcosynchro/pcomutex.h>
+#include <pcosynchro/pcoconditionvariable.h>
+
+#include "config.h"
+
+/**
+ * @brief Hierarchical timer wheel with O(1) insertion and cancellation.
+ *
+ * Four levels of 64 slots cover 2^24 ticks; a timer is placed in the
+ * coarsest level that still resolves it and moves down a level each time
+ * the finer level wraps around. Timers further away than the last level
+ * are parked in its last slot and rescheduled when they come up.
+ *
+ * Timers live in a pool of compact nodes linked by index, so a pending
+ * timer costs 48 bytes and no allocation once the pool has grown. Handlers
+ * run on the thread executing run(), without the wheel lock held, so they
+ * may take other locks or schedule new timers.
+ *
+ * Time is simulated: it flows @ref TIME_SCALE times faster than real time,
+ * unless another scale is set with setTimeScale().
+ */
+class TimerWheel
+{
+public:
+    /**
+     * @brief Identifier of a scheduled timer (0 means no timer).
+     */
+    using TimerId = unsigned long long;
+
+    /**
+     * @brief Function called when a timer expires.
+     *
+     * @param _context Pointer given to schedule().
+     * @param _arg Value given to schedule().
+     */
+    using Handler = void (*)(void* _context, unsigned long long _arg);
+
+    /**
+     * @brief Returns the wheel shared by the whole simulation.
+     */
+    static TimerWheel& instance();
+
+    /**
+     * @brief Schedules a handler.
+     *
+     * @param _delayMs Delay in simulated milliseconds.
+     * @param _handler Function to call on expiry.
+     * @param _context First argument of the handler.
+     * @param _arg Second argument of the handler.
+     * @return Identifier that can be passed to cancel(), or 0 if the wheel
+     *         is stopped and the handler will never run.
+     */
+    TimerId schedule(unsigned int _delayMs, Handler _handler, void* _context,
+                     unsigned long long _arg = 0);
+
+    /**
+     * @brief Cancels a timer that has not fired yet.
+     *
+     * @param _id Identifier returned by schedule().
+     * @return true if the timer was pending and will not fire.
+     */
+    bool cancel(TimerId _id);
+
+    /**
+     * @brief Blocks the calling thread for a simulated duration.
+     *
+     * The thread waits on its own condition variable and is woken by the
+     * wheel, so any number of threads can sleep with a single driver.
+     * Returns immediately once the wheel is stopped.
+     *
+     * @param _ms Duration in simulated milliseconds.
+     */
+    void sleepFor(unsigned int _ms);
+
+    /**
+     * @brief Returns the simulated time elapsed since the wheel was created.
+     *
+     * @return Simulated time in milliseconds, start time included.
+     */
+    unsigned long long nowMs() const;
+
+    /**
+     * @brief Sets the simulated time at which the wheel starts.
+     *
+     * Used to resume a checkpoint; must be called before run() and before
+     * any timer is scheduled.
+     *
+     * @param _simMs Simulated time in milliseconds.
+     */
+    void setStartTime(unsigned long long _simMs);
+
+    /**
+     * @brief Sets how many times faster than real time the simulated clock flows.
+     *
+     * Used by headless runs; must be called before run() and before any
+     * timer is scheduled.
+     *
+     * @param _scale Time scale (> 0).
+     */
+    void setTimeScale(double _scale);
+
+    /**
+     * @brief Converts a simulated duration to real time.
+     *
+     * @param _simMs Duration in simulated milliseconds.
+     * @return Duration in real milliseconds.
+     */
+    unsigned int toRealMs(unsigned int _simMs) const;
+
+    /**
+     * @brief Drives the wheel until stop() is called.
+     *
+     * Meant to run in its own thread.
+     */
+    void run();
+
+    /**
+     * @brief Stops the wheel.
+     *
+     * Every pending timer fires at once, which wakes all sleeping threads,
+     * and later calls to schedule() or sleepFor() return immediately.
+     */
+    void stop();
+
+private:
+    TimerWheel();
+
+    static const unsigned int slotBits = 6;
+    static const unsigned int nbSlots = 1u << slotBits;
+    static const unsigned int nbLevels = 4;
+    static const std::uint32_t noNode = 0xFFFFFFFFu;
+
+    /**
+     * @brief Noeud de la roue : minuterie en attente ou sentinelle d'un slot.
+     */
+    struct Node
+    {
+        std::uint32_t prev;
+        std::uint32_t next;
+        std::uint32_t generation;
+        bool linked;
+        unsigned long long expiryTick;
+        Handler handler;
+        void* context;
+        unsigned long long arg;
+    };
+
+    /**
+     * @brief Minuterie échue, à exécuter hors du verrou.
+     */
+    struct Expired
+    {
+        Handler handler;
+        void* context;
+        unsigned long long arg;
+    };
+
+    /**
+     * @brief État d'un thread endormi par sleepFor().
+     */
+    struct Sleeper
+    {
+        PcoMutex mutex;
+        PcoConditionVariable woken;
+        bool done = false;
+    };
+
+    static void wakeSleeper(void* _sleeper, unsigned long long _arg);
+
+    /**
+     * @brief Returns the tick corresponding to the current simulated time.
+     */
+    unsigned long long currentTick() const;
+
+    /**
+     * @brief Index of the sentinel of a slot.
+     */
+    static std::uint32_t sentinel(unsigned int _level, unsigned int _slot)
+    {
+        return _level * nbSlots + _slot;
+    }
+
+    // Toutes les fonctions suivantes s'appellent sous le mutex
+    std::uint32_t allocate();
+    void release(std::uint32_t _index);
+    void link(std::uint32_t _index);
+    void unlink(std::uint32_t _index);
+    void cascade(unsigned int _level);
+    void collectSlot(std::uint32_t _sentinel, std::vector<Expired>& _expired);
+
+    /**
+     * @brief Pool des noeuds ; les nbLevels * nbSlots premiers sont les sentinelles.
+     */
+    std::vector<Node> nodes;
+
+    /**
+     * @brief Premier noeud libre du pool (liste chaînée par next).
+     */
+    std::uint32_t freeList = noNode;
+
+    /**
+     * @brief Prochain tick à traiter.
+     */
+    unsigned long long baseTick = 0;
+
+    bool stopped = false;
+
+    std::chrono::steady_clock::time_point start;
+
+    /**
+     * @brief Temps simulé au démarrage (reprise d'une sauvegarde).
+     */
+    unsigned long long startMs = 0;
+
+    double timeScale = TIME_SCALE;
+
+    mutable PcoMutex mutex;
+};
+
+#endif // TIMERWHEEL_H
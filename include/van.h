@@ -15,10 +15,15 @@
 
 #include <vector>
 #include <array>
+#include <optional>
 #include <pcosynchro/pcothread.h>
 #include "config.h"
 #include "bikestation.h"
-#include "bikinginterface.h"
+#include "simulationview.h"
+#include "sitemap.h"
+#include "imbalanceindex.h"
+#include "checkpoint.h"
+#include "vancargo.h"
 
 /**
  * @brief Simulates the van that rebalances bikes between sites and the depot.
@@ -45,7 +50,7 @@ public:
      *
      * Repeatedly:
      *  - loads bikes at the depot,
-     *  - visits sites to balance bike counts,
+     *  - visits the sites that need it to balance bike counts,
      *  - returns to the depot.
      * This function is usually run in its own thread and never returns.
      */
@@ -56,7 +61,7 @@ public:
      *
      * @param _binkingInterface Pointer to the interface implementation.
      */
-    static void setInterface(BikingInterface* _binkingInterface);
+    static void setInterface(SimulationView* _binkingInterface);
 
     /**
      * @brief Sets the array of bike stations used by the van.
@@ -65,13 +70,61 @@ public:
      */
     static void setStations(const std::array<BikeStation*, NB_SITES_TOTAL>& _stations);
 
+    /**
+     * @brief Sets the spatial model used for driving times.
+     *
+     * @param _siteMap Site map shared by all vans (may be null, in which case
+     *        driving times are uniformly random).
+     */
+    static void setSiteMap(const SiteMap* _siteMap);
+
+    /**
+     * @brief Sets the number of bikes the vans aim to leave at each site.
+     *
+     * @param _target Target bike count per site (default: BORNES - 2).
+     */
+    static void setStationTarget(size_t _target);
+
+    /**
+     * @brief Sets the global imbalance index the vans plan their tours from.
+     *
+     * @param _index Index fed by the sites (may be null, in which case every
+     *        site is considered at each tour).
+     */
+    static void setImbalanceIndex(ImbalanceIndex* _index);
+
+    /**
+     * @brief Restores the state saved in a checkpoint.
+     *
+     * Must be called before run().
+     *
+     * @param _state Saved state of the van.
+     * @param _cargo Bikes loaded in the van.
+     * @return false if the cargo does not fit in the van.
+     */
+    bool restore(const AgentState& _state, std::vector<Bike*> _cargo);
+
 private:
     /**
-     * @brief Writes a message about the van to the user interface console.
+     * @brief Indicates that the thread of the van has been asked to stop.
+     */
+    static bool stopping();
+
+    /**
+     * @brief Builds the state published for checkpoints.
      *
-     * @param msg Message to log.
+     * @param _site Site where the van is, or is heading to.
+     * @return State of the van, cargo included (valid until the next call).
      */
-    void log(const QString& msg) const;
+    const AgentState& agentState(unsigned int _site);
+
+    /**
+     * @brief Adds an entry about the van to the user interface log.
+     *
+     * @param _message Message identifier.
+     * @param _arg0 First argument of the message (see LogMessage).
+     */
+    void log(LogMessage _message, long long _arg0 = 0) const;
 
     /**
      * @brief Simulates driving the van from the current site to a destination site.
@@ -82,6 +135,27 @@ private:
      */
     void driveTo(unsigned int _dest);
 
+    /**
+     * @brief Returns the sites worth considering for the next tour, in order.
+     *
+     * The VAN_TOUR_CANDIDATES most starved sites, most saturated sites and
+     * sites with the most flagged bikes of the imbalance index, or every
+     * site if there is no index.
+     */
+    std::vector<unsigned int> tourCandidates() const;
+
+    /**
+     * @brief Chooses the sites to visit during the next tour.
+     *
+     * Walks the candidates in order on their snapshots, tracking the expected
+     * cargo, and keeps the sites where the van can actually collect flagged
+     * or surplus bikes, or drop bikes to fill a deficit.
+     *
+     * @param _candidates Sites to consider, in visiting order.
+     * @return Sites to visit, in order.
+     */
+    std::vector<unsigned int> planTour(const std::vector<unsigned int>& _candidates) const;
+
     /**
      * @brief Loads bikes from the depot into the van.
      *
@@ -93,8 +167,10 @@ private:
     /**
      * @brief Balances the number of bikes at a given site.
      *
+     * Bikes flagged for maintenance are always collected first.
      * If the site has more bikes than the target, the van takes some bikes.
      * If the site has fewer bikes than the target, the van drops bikes from its cargo.
+     * The whole stop is done atomically by BikeStation::rebalance().
      *
      * @param _s Index of the site to balance.
      */
@@ -103,21 +179,11 @@ private:
     /**
      * @brief Returns to the depot and drops all remaining bikes.
      *
-     * Any bikes still in the cargo are added back to the depot station.
+     * Bikes flagged for maintenance are serviced, then any bikes still in the
+     * cargo are added back to the depot station.
      */
     void returnToDepot();
 
-    /**
-     * @brief Takes a bike of a given type from the van cargo.
-     *
-     * Searches the cargo for a bike of @p type, removes it if found,
-     * and returns it.
-     *
-     * @param type Desired bike type index.
-     * @return Pointer to the bike if found, nullptr otherwise.
-     */
-    Bike* takeBikeFromCargo(size_t type);
-
     /**
      * @brief Identifier of the van.
      */
@@ -131,19 +197,54 @@ private:
     unsigned int currentSite;
 
     /**
-     * @brief Collection of bikes currently loaded in the van.
+     * @brief Bikes currently loaded in the van, bucketed by type.
      */
-    std::vector<Bike*> cargo;
+    VanCargo cargo;
+
+    /**
+     * @brief Slot where the van publishes its state for checkpoints.
+     */
+    Checkpoint::Slot* checkpointSlot = nullptr;
+
+    /**
+     * @brief State rebuilt in place by agentState().
+     */
+    AgentState publishedState;
+
+    /**
+     * @brief Random generator state to resume with, if restored.
+     */
+    std::optional<FastRng::State> restoredRng;
+
+    /**
+     * @brief Bikes loaded or unloaded since the start of the current tour.
+     */
+    size_t bikesMoved = 0;
 
     /**
      * @brief User interface shared by all vans (may be null).
      */
-    static BikingInterface* binkingInterface;
+    static SimulationView* binkingInterface;
 
     /**
      * @brief Shared array of bike stations for all sites and the depot.
      */
     static std::array<BikeStation*, NB_SITES_TOTAL> stations;
+
+    /**
+     * @brief Spatial model shared by all vans (may be null).
+     */
+    static const SiteMap* siteMap;
+
+    /**
+     * @brief Target bike count per site shared by all vans.
+     */
+    static size_t stationTarget;
+
+    /**
+     * @brief Global imbalance index of the sites (may be null).
+     */
+    static ImbalanceIndex* imbalanceIndex;
 };
 
 #endif // VAN_H
@@ -0,0 +1,115 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : vancargo.h
+ * Chargement du van : conteneur de capacité fixe stocké en place (aucune allocation), avec un
+ * compartiment par type de vélo et un compartiment pour les vélos à réviser. Compter ou retirer
+ * un vélo d'un type donné se fait en temps constant.
+ */
+
+#ifndef VANCARGO_H
+#define VANCARGO_H
+
+#include <array>
+#include <cstddef>
+#include "config.h"
+#include "bike.h"
+
+/**
+ * @brief Fixed-capacity cargo of a van, bucketed by bike type.
+ *
+ * Bikes flagged for maintenance go to a separate bucket: they are never
+ * counted nor returned by count() and take(), only by the maintenance
+ * accessors. Each bucket is a small stack sized for the whole capacity, so
+ * any mix of types fits without allocation.
+ *
+ * @tparam Capacity Maximum number of bikes carried.
+ */
+template<size_t Capacity>
+class BasicVanCargo
+{
+public:
+    static constexpr size_t capacity = Capacity;
+
+    size_t size() const { return total; }
+    bool empty() const { return total == 0; }
+    bool full() const { return total == Capacity; }
+
+    /**
+     * @brief Returns the number of rideable bikes of a type.
+     */
+    size_t count(size_t _type) const { return counts[_type]; }
+
+    /**
+     * @brief Returns the number of bikes flagged for maintenance.
+     */
+    size_t countForMaintenance() const { return counts[maintenanceBucket]; }
+
+    /**
+     * @brief Loads a bike.
+     *
+     * @param _bike Bike to load (goes to the maintenance bucket if flagged).
+     * @return false if the cargo is full (the bike is not loaded).
+     */
+    bool push(Bike* _bike) {
+        if (full())
+            return false;
+        size_t bucket = _bike->needsMaintenance ? maintenanceBucket : _bike->bikeType;
+        buckets[bucket][counts[bucket]++] = _bike;
+        ++total;
+        return true;
+    }
+
+    /**
+     * @brief Unloads a rideable bike of a type.
+     *
+     * @return The bike, or nullptr if there is none of this type.
+     */
+    Bike* take(size_t _type) { return takeFrom(_type); }
+
+    /**
+     * @brief Unloads a bike flagged for maintenance.
+     *
+     * @return The bike, or nullptr if there is none.
+     */
+    Bike* takeForMaintenance() { return takeFrom(maintenanceBucket); }
+
+    /**
+     * @brief Calls a function on every bike, flagged ones included.
+     */
+    template<class F>
+    void forEach(F&& _f) const {
+        for (size_t bucket = 0; bucket < nbBuckets; ++bucket)
+            for (size_t i = 0; i < counts[bucket]; ++i)
+                _f(buckets[bucket][i]);
+    }
+
+    void clear() {
+        counts.fill(0);
+        total = 0;
+    }
+
+private:
+    static constexpr size_t maintenanceBucket = Bike::nbBikeTypes;
+    static constexpr size_t nbBuckets = Bike::nbBikeTypes + 1;
+
+    Bike* takeFrom(size_t _bucket) {
+        if (counts[_bucket] == 0)
+            return nullptr;
+        --total;
+        return buckets[_bucket][--counts[_bucket]];
+    }
+
+    std::array<std::array<Bike*, Capacity>, nbBuckets> buckets{};
+    std::array<size_t, nbBuckets> counts{};
+    size_t total = 0;
+};
+
+/**
+ * @brief Cargo of the vans of the simulation.
+ */
+using VanCargo = BasicVanCargo<VAN_CAPACITY>;
+
+#endif // VANCARGO_H
@@ -0,0 +1,138 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : waitpolicy.h
+ * Attente adaptative des stations : avant de s'endormir sur une variable de condition, un thread
+ * tente encore sa chance en boucle active pendant un budget de temps court. Ce budget suit la
+ * latence des dernières remises (temps entre le début d'une attente et l'obtention du vélo ou de
+ * la borne) : là où un vélo revient en quelques microsecondes on tourne, là où il faut attendre
+ * un retour à vélo on s'endort tout de suite.
+ */
+
+#ifndef WAITPOLICY_H
+#define WAITPOLICY_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/**
+ * @brief Spin-then-park settings of a class of stations.
+ *
+ * The spin budget is twice the recent hand-off latency, clamped to
+ * [minSpinNs, maxSpinNs]; when that latency exceeds maxSpinNs, only
+ * minSpinNs is spun (enough to notice the station became fast again).
+ * A policy with maxSpinNs == 0 parks at once.
+ */
+struct WaitPolicy
+{
+    std::uint64_t minSpinNs = 0;
+    std::uint64_t maxSpinNs = 0;
+
+    /**
+     * @brief Weight of a new hand-off in the latency average, as a power of two (1/2^shift).
+     */
+    unsigned int averageShift = 3;
+};
+
+/**
+ * @brief Adaptive spin phase of one kind of wait at one station.
+ *
+ * Thread-safe: the latency average is a relaxed atomic, an approximate
+ * value being enough to size the budget.
+ */
+class AdaptiveSpin
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit AdaptiveSpin(const WaitPolicy& _policy) : policy(_policy) {}
+
+    /**
+     * @brief Returns the current spin budget in nanoseconds.
+     */
+    std::uint64_t budgetNs() const {
+        std::uint64_t latency = averageNs.load(std::memory_order_relaxed);
+        if (latency > policy.maxSpinNs)
+            return policy.minSpinNs;
+        return std::clamp<std::uint64_t>(2 * latency, policy.minSpinNs, policy.maxSpinNs);
+    }
+
+    /**
+     * @brief Calls @p _tryAcquire with exponential backoff until it succeeds or the budget is spent.
+     *
+     * @param _start Start of the wait, used for the budget.
+     * @param _tryAcquire Callable returning true once the resource is obtained.
+     * @return true if the resource was obtained while spinning.
+     */
+    template<class F>
+    bool spin(Clock::time_point _start, F&& _tryAcquire) const {
+        const std::uint64_t budget = budgetNs();
+        if (budget == 0)
+            return false;
+
+        unsigned int backoff = 1;
+        for (;;) {
+            if (_tryAcquire())
+                return true;
+            if (elapsedNs(_start) >= budget)
+                return false;
+
+            // Recul exponentiel ; au-delà du plafond on cède le coeur plutôt que de le brûler
+            if (backoff <= MAX_PAUSES) {
+                for (unsigned int i = 0; i < backoff; ++i)
+                    cpuRelax();
+                backoff *= 2;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * @brief Records the latency of a hand-off that started at @p _start.
+     */
+    void record(Clock::time_point _start) {
+        std::uint64_t sample = elapsedNs(_start);
+        std::uint64_t average = averageNs.load(std::memory_order_relaxed);
+        // Moyenne mobile exponentielle ; une mise à jour perdue en concurrence est sans importance
+        std::int64_t delta = static_cast<std::int64_t>(sample) - static_cast<std::int64_t>(average);
+        averageNs.store(average + (delta >> policy.averageShift), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the recent hand-off latency in nanoseconds.
+     */
+    std::uint64_t latencyNs() const { return averageNs.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr unsigned int MAX_PAUSES = 64;
+
+    static std::uint64_t elapsedNs(Clock::time_point _start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start).count();
+    }
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    const WaitPolicy policy;
+
+    /**
+     * @brief Latence moyenne des remises récentes ; 0 au départ, on tente donc de tourner.
+     */
+    std::atomic<std::uint64_t> averageNs{0};
+};
+
+#endif // WAITPOLICY_H
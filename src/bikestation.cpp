@@ -8,20 +8,142 @@
  * Elle utilise un mutex et des variables de condition (slots_available et bikes_of_type_available)
  * pour la synchronisation des accès aux ressources partagées (dépôt et retrait de vélos) par différentes entités
  * (utilisateurs, van de maintenance).
+ * Chemin rapide : une personne qui trouve un vélo ou une borne libre passe par les compteurs atomiques et
+ * les files sans verrou ; elle ne prend le mutex que pour réveiller un thread bloqué, s'il y en a un.
  */
 
 #include "bikestation.h"
+#include "config.h"
 #include <pcosynchro/pcomutex.h>
 
-BikeStation::BikeStation(int _capacity) : capacity(_capacity) {}
+#include <algorithm>
+#include <thread>
+
+std::atomic<unsigned long long> BikeStation::nextReservationId{1};
+
+BikeStation::BikeStation(int _capacity, const WaitPolicy& _waitPolicy, const AdmissionLimits& _admission)
+    : capacity(_capacity), riderSpin(_waitPolicy), depositorSpin(_waitPolicy), admission(_admission),
+      history(capacity, STATION_LOG_EVENTS, STATION_LOG_SNAPSHOTS) {
+    // Une file par type peut contenir toute la station
+    for (auto& queue : storage)
+        queue.allocate(capacity);
+    freeSlotCount.store(static_cast<long>(capacity), std::memory_order_relaxed);
+}
 
 BikeStation::~BikeStation() {
     ending();
+
+    // Les minuteries des réservations pointent sur la station : aucune ne doit lui survivre
+    mutex.lock();
+    for (size_t i = 0; i < reservations.size();)
+    {
+        // Identifiant nul : roue arrêtée, le handler ne s'exécutera jamais
+        TimerWheel::TimerId timer = reservations[i].timer;
+        if (timer == 0 || TimerWheel::instance().cancel(timer))
+        {
+            reservations[i] = reservations.back();
+            reservations.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    // Les autres sont déjà échues : leur handler retire la réservation sous le mutex
+    while (!reservations.empty())
+        mutex.wait(reservation_expired);
+    mutex.unlock();
+}
+
+bool BikeStation::claim(std::atomic<long>& _counter) {
+    // seq_cst : une attente qui voit le compteur à zéro est forcément vue par le prochain signaleur
+    long value = _counter.load(std::memory_order_seq_cst);
+    while (value > 0)
+    {
+        if (_counter.compare_exchange_weak(value, value - 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+Bike* BikeStation::popClaimed(size_t _bikeType) {
+    // Le vélo réclamé est dans la file, ou son dépôt est sur le point d'y être visible
+    Bike* bike = nullptr;
+    while (!storage[_bikeType].tryPop(bike))
+        std::this_thread::yield();
+    return bike;
+}
+
+void BikeStation::pushAvailable(Bike* _bike) {
+    // La borne est réclamée et la file a la capacité de la station : seul un retrait en cours
+    // sur la même case peut retarder l'insertion
+    while (!storage[_bike->bikeType].tryPush(_bike))
+        std::this_thread::yield();
+    available[_bike->bikeType].fetch_add(1, std::memory_order_seq_cst);
+}
+
+void BikeStation::releaseSlots(size_t _count) {
+    freeSlotCount.fetch_add(static_cast<long>(_count), std::memory_order_seq_cst);
+}
+
+bool BikeStation::enterFastPath() {
+    fastPathUsers.fetch_add(1, std::memory_order_seq_cst);
+    if (fastPathClosed.load(std::memory_order_seq_cst) || endSimulation.load(std::memory_order_relaxed))
+    {
+        leaveFastPath();
+        return false;
+    }
+    return true;
+}
+
+void BikeStation::leaveFastPath() {
+    fastPathUsers.fetch_sub(1, std::memory_order_release);
+}
+
+bool BikeStation::tryPutFast(Bike* _bike) {
+    if (!enterFastPath())
+        return false;
+
+    bool stored = claim(freeSlotCount);
+    if (stored)
+    {
+        record(StationLog::Put, _bike->bikeType, 1);
+        pushAvailable(_bike);
+    }
+    leaveFastPath();
+
+    size_t type = _bike->bikeType;
+    if (stored && waitingRiders[type].load(std::memory_order_seq_cst) > 0)
+    {
+        mutex.lock();
+        bikes_of_type_available[type].notifyOne();
+        mutex.unlock();
+    }
+    return stored;
 }
 
-void BikeStation::putBike(Bike* _bike) {
+void BikeStation::putBike(Bike* _bike, bool* _overloaded) {
     if (!_bike) return; // Sécurité
 
+    // Chemin rapide : une borne libre et un vélo en état, sans mutex,
+    // puis boucle active si les dernières bornes se sont libérées vite
+    // Lu une seule fois : une fois déposé, le vélo peut déjà être reparti
+    const bool flagged = _bike->needsMaintenance;
+    AdaptiveSpin::Clock::time_point start;
+    if (!flagged)
+    {
+        if (tryPutFast(_bike))
+            return;
+
+        start = AdaptiveSpin::Clock::now();
+        if (depositorSpin.spin(start, [&] { return tryPutFast(_bike); }))
+        {
+            depositorSpin.record(start);
+            return;
+        }
+    }
+
     mutex.lock();
 
     if (endSimulation)
@@ -31,143 +153,682 @@ void BikeStation::putBike(Bike* _bike) {
     }
 
     // While car moniteur Mesa. Si aucun slot de libre
-    while (nbBikes() >= capacity && !endSimulation)
+    waitingDepositors.fetch_add(1, std::memory_order_seq_cst);
+    bool slotClaimed = false;
+    bool admitted = (_overloaded == nullptr);
+    while (!endSimulation && !(slotClaimed = claim(freeSlotCount)))
     {
-        slots_available.wait(&mutex);
+        // Contrôle d'admission : file déjà pleine, refus immédiat (compteur modifié sous le mutex seulement)
+        if (!admitted)
+        {
+            if (waitingDepositors.load(std::memory_order_relaxed) > admission.maxWaitingDepositors)
+                break;
+            admitted = true;
+        }
+        mutex.wait(slots_available);
     }
+    waitingDepositors.fetch_sub(1, std::memory_order_relaxed);
 
-    if (endSimulation)
+    if (!slotClaimed)
     {
+        if (!admitted && !endSimulation)
+        {
+            *_overloaded = true;
+            overloadedCount.fetch_add(1, std::memory_order_relaxed);
+        }
         mutex.unlock();
         return;
     }
 
-    // Déposer vélo
+    // Déposer vélo (journal d'abord : il peut repartir dès qu'il est rangé)
+    beginPublish();
+    record(StationLog::Put, logCounter(_bike), 1);
+    storeBike(_bike);
+    endPublish();
+
+    mutex.unlock();
+
+    if (!flagged)
+        depositorSpin.record(start);
+}
+
+void BikeStation::storeBike(Bike* _bike) {
+    // Vélo à réviser : il occupe une borne mais reste réservé au van
+    if (_bike->needsMaintenance)
+    {
+        maintenance.push_back(_bike);
+        return;
+    }
+
     size_t type = _bike->bikeType;
-    storage[type].push_back(_bike);
+    pushAvailable(_bike);
 
     // On signale vélo libre
     bikes_of_type_available[type].notifyOne();
+}
 
-    mutex.unlock();
+unsigned int BikeStation::logCounter(const Bike* _bike) {
+    return _bike->needsMaintenance ? StationLog::maintenanceCounter
+                                   : static_cast<unsigned int>(_bike->bikeType);
 }
 
-Bike* BikeStation::getBike(size_t _bikeType) {
+Bike* BikeStation::tryGetFast(size_t _bikeType) {
+    if (!enterFastPath())
+        return nullptr;
+
+    Bike* bike = claim(available[_bikeType]) ? popClaimed(_bikeType) : nullptr;
+    if (bike)
+    {
+        record(StationLog::Get, _bikeType, -1);
+        releaseSlots(1);
+    }
+    leaveFastPath();
+
+    if (bike && waitingDepositors.load(std::memory_order_seq_cst) > 0)
+    {
+        mutex.lock();
+        slots_available.notifyOne();
+        mutex.unlock();
+    }
+    return bike;
+}
+
+Bike* BikeStation::getBike(size_t _bikeType, bool* _overloaded) {
+    // Chemin rapide : un vélo du type est disponible, sans mutex
+    Bike* bike = tryGetFast(_bikeType);
+    if (bike)
+        return bike;
+
+    // Boucle active si les derniers vélos sont revenus vite, sinon attente dans le moniteur
+    const AdaptiveSpin::Clock::time_point start = AdaptiveSpin::Clock::now();
+    if (riderSpin.spin(start, [&] { return (bike = tryGetFast(_bikeType)) != nullptr; }))
+    {
+        riderSpin.record(start);
+        return bike;
+    }
+
     mutex.lock();
 
     // Si vélo souhaité pas dispo
-    while (storage[_bikeType].empty() && !endSimulation)
+    waitingRiders[_bikeType].fetch_add(1, std::memory_order_seq_cst);
+    bool bikeClaimed = false;
+    bool admitted = (_overloaded == nullptr);
+    while (!endSimulation && !(bikeClaimed = claim(available[_bikeType])))
     {
-        bikes_of_type_available[_bikeType].wait(&mutex);
+        // Contrôle d'admission : file déjà pleine, refus immédiat (compteur modifié sous le mutex seulement)
+        if (!admitted)
+        {
+            if (waitingRiders[_bikeType].load(std::memory_order_relaxed) > admission.maxWaitingRiders)
+                break;
+            admitted = true;
+        }
+        mutex.wait(bikes_of_type_available[_bikeType]);
     }
+    waitingRiders[_bikeType].fetch_sub(1, std::memory_order_relaxed);
 
-    if (endSimulation)
+    if (!bikeClaimed)
     {
+        if (!admitted && !endSimulation)
+        {
+            *_overloaded = true;
+            overloadedCount.fetch_add(1, std::memory_order_relaxed);
+        }
         mutex.unlock();
         return nullptr;
     }
 
     // Récupération vélo
-    Bike* bike = storage[_bikeType].front();
-    storage[_bikeType].pop_front();
+    bike = popClaimed(_bikeType);
+    record(StationLog::Get, _bikeType, -1);
+    releaseSlots(1);
 
     // On signale slot libre
     slots_available.notifyOne();
 
     mutex.unlock();
 
+    riderSpin.record(start);
     return bike;
 }
 
-std::vector<Bike*> BikeStation::addBikes(std::vector<Bike*> _bikesToAdd) {
-
+size_t BikeStation::addBikes(std::span<Bike* const> _bikesToAdd) {
     mutex.lock();
-    std::vector<Bike*> rejectedBikes;
 
     // Si la station est en cours d'arrêt, on rejette tous les vélos
     if (endSimulation)
     {
         mutex.unlock();
-        return _bikesToAdd;
+        return 0;
     }
 
-    for (Bike* bike : _bikesToAdd)
+    beginPublish();
+
+    // On réclame les bornes dans l'ordre tant qu'il y en a : le reste est rejeté
+    size_t added = 0;
+    StationLog::Counts addedTo{};
+    while (added < _bikesToAdd.size() && claim(freeSlotCount))
     {
-        // Il y a de la place
-        if (nbBikes() < capacity)
-        {
-            size_t type = bike->bikeType;
-            storage[type].push_back(bike);
-            bikes_of_type_available[type].notifyAll();
-        }
-        else
-        {
-            // Pas de place, on retourne le vélo au Van
-            rejectedBikes.push_back(bike);
-        }
+        ++addedTo[logCounter(_bikesToAdd[added])];
+        ++added;
     }
 
+    // Journal : une entrée par compteur modifié, avant que les vélos soient visibles
+    for (unsigned int counter = 0; counter < StationLog::nbCounters; ++counter)
+    {
+        if (addedTo[counter] > 0)
+            record(StationLog::AddBikes, counter, addedTo[counter]);
+    }
+
+    for (size_t i = 0; i < added; ++i)
+        storeBike(_bikesToAdd[i]);
+
+    endPublish();
     mutex.unlock();
-    return rejectedBikes;
+    return added;
 }
 
-std::vector<Bike*> BikeStation::getBikes(size_t _nbBikes) {
+std::vector<Bike*> BikeStation::addBikes(std::vector<Bike*> _bikesToAdd) {
+    size_t added = addBikes(std::span<Bike* const>(_bikesToAdd));
+    _bikesToAdd.erase(_bikesToAdd.begin(), _bikesToAdd.begin() + added);
+    return _bikesToAdd;
+}
+
+size_t BikeStation::getBikes(std::span<Bike*> _out) {
     mutex.lock();
 
-    std::vector<Bike*> retrievedBikes;
+    // Retrait de plusieurs types : publié comme une seule mutation
+    beginPublish();
     size_t count = 0;
 
     // On parcourt les types de 0 à N
     for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
     {
         // Tant qu'on n'a pas atteint la limite et qu'il y a des vélos de ce type
-        while (count < _nbBikes && !storage[type].empty())
+        size_t before = count;
+        while (count < _out.size() && claim(available[type]))
         {
-            Bike* bike = storage[type].front();
-            storage[type].pop_front();
-            retrievedBikes.push_back(bike);
-            count++;
+            _out[count++] = popClaimed(type);
         }
+        if (count > before)
+            record(StationLog::RemoveBikes, type, -static_cast<long>(count - before));
 
-        if (count >= _nbBikes) break;
+        if (count >= _out.size()) break;
     }
 
     // Comme on a pu libérer beaucoup de places, on réveille tout le monde en attente de slot.
     if (count > 0) {
+        releaseSlots(count);
         slots_available.notifyAll();
     }
 
+    endPublish();
     mutex.unlock();
+    return count;
+}
+
+std::vector<Bike*> BikeStation::getBikes(size_t _nbBikes) {
+    std::vector<Bike*> retrievedBikes(std::min(_nbBikes, capacity));
+    retrievedBikes.resize(getBikes(std::span<Bike*>(retrievedBikes)));
     return retrievedBikes;
 }
 
+size_t BikeStation::getBikesForMaintenance(std::span<Bike*> _out) {
+    mutex.lock();
+
+    beginPublish();
+    size_t count = 0;
+
+    while (count < _out.size() && !maintenance.empty())
+    {
+        _out[count++] = maintenance.front();
+        maintenance.pop_front();
+    }
+
+    if (count > 0) {
+        record(StationLog::RemoveBikes, StationLog::maintenanceCounter, -static_cast<long>(count));
+        releaseSlots(count);
+        slots_available.notifyAll();
+    }
+
+    endPublish();
+    mutex.unlock();
+    return count;
+}
+
+std::vector<Bike*> BikeStation::getBikesForMaintenance(size_t _nbBikes) {
+    std::vector<Bike*> retrievedBikes(std::min(_nbBikes, capacity));
+    retrievedBikes.resize(getBikesForMaintenance(std::span<Bike*>(retrievedBikes)));
+    return retrievedBikes;
+}
+
+StationState BikeStation::rebalance(const RebalancePlan& _plan, VanCargo& _cargo) {
+    mutex.lock();
+
+    StationState state;
+
+    if (!endSimulation)
+    {
+        // Retraits et dépôts publiés ensemble : un lecteur ne voit ni l'un sans l'autre
+        beginPublish();
+
+        const size_t cargoCapacity = std::min(_plan.cargoCapacity, VanCargo::capacity);
+
+        // Vélos à réviser : toujours récupérés en premier
+        long maintenanceTaken = 0;
+        while (_cargo.size() < cargoCapacity && !maintenance.empty())
+        {
+            _cargo.push(maintenance.front());
+            maintenance.pop_front();
+            ++state.taken;
+            ++maintenanceTaken;
+        }
+
+        // Surplus : retirer des vélos vers la camionnette (types dans l'ordre, FIFO)
+        size_t Vi = storedBikes();
+        std::array<size_t, Bike::nbBikeTypes> removed{};
+        for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+        {
+            while (Vi > _plan.target && _cargo.size() < cargoCapacity && claim(available[type]))
+            {
+                _cargo.push(popClaimed(type));
+                ++removed[type];
+                ++state.taken;
+                --Vi;
+            }
+        }
+
+        // Journal des retraits (une entrée par compteur modifié) avant de libérer leurs bornes
+        if (maintenanceTaken > 0)
+            record(StationLog::RemoveBikes, StationLog::maintenanceCounter, -maintenanceTaken);
+        for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+        {
+            if (removed[type] > 0)
+                record(StationLog::RemoveBikes, type, -static_cast<long>(removed[type]));
+        }
+        if (state.taken > 0)
+            releaseSlots(state.taken);
+
+        // Déficit : déposer les vélos de la camionnette, types manquants en priorité.
+        // Chaque dépôt réclame une borne libre : les bornes réservées ne sont pas occupées par le van.
+        // Les vélos ne sont rendus visibles qu'une fois leur dépôt journalisé
+        std::array<size_t, Bike::nbBikeTypes> added{};
+        std::array<Bike*, VanCargo::capacity> dropped;
+        auto stock = [&](size_t type) { return available[type].load() + static_cast<long>(added[type]); };
+        auto drop = [&](size_t type) {
+            if (Vi >= _plan.target || !claim(freeSlotCount))
+                return false;
+            dropped[state.dropped++] = _cargo.take(type);
+            ++added[type];
+            ++Vi;
+            return true;
+        };
+
+        for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+        {
+            if (stock(type) == 0 && _cargo.count(type) > 0 && !drop(type))
+                break;
+        }
+
+        // Puis le type le moins présent dans la station parmi ceux du chargement
+        while (true)
+        {
+            size_t best = Bike::nbBikeTypes;
+            for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+            {
+                if (_cargo.count(type) > 0 && (best == Bike::nbBikeTypes || stock(type) < stock(best)))
+                    best = type;
+            }
+            if (best == Bike::nbBikeTypes || !drop(best))
+                break;
+        }
+
+        for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+        {
+            if (added[type] > 0)
+                record(StationLog::AddBikes, type, static_cast<long>(added[type]));
+        }
+        for (size_t i = 0; i < state.dropped; ++i)
+            pushAvailable(dropped[i]);
+
+        // Un seul réveil par type approvisionné et pour les places libérées
+        for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+        {
+            if (added[type] > 0)
+                bikes_of_type_available[type].notifyAll();
+        }
+        if (state.taken > state.dropped)
+            slots_available.notifyAll();
+
+        endPublish();
+    }
+
+    state.nbBikes = storedBikes();
+    for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+        state.bikesOfType[type] = static_cast<size_t>(std::max(0L, available[type].load()));
+    state.nbForMaintenance = maintenance.size();
+
+    mutex.unlock();
+    return state;
+}
+
+Reservation BikeStation::reserveBike(size_t _bikeType, unsigned int _ttlMs) {
+    Reservation reservation;
+
+    mutex.lock();
+
+    // Le vélo quitte les disponibles et rejoint les réservés dans la même publication
+    beginPublish();
+    if (!endSimulation && claim(available[_bikeType]))
+    {
+        reservation.id = nextReservationId++;
+
+        // Le vélo est mis de côté tout de suite : il garde sa borne
+        Bike* bike = popClaimed(_bikeType);
+        ++reservedBikes;
+        record(StationLog::Reserve, _bikeType, -1);
+        record(StationLog::Reserve, StationLog::reservedCounter, 1);
+
+        unsigned long long id = reservation.id;
+        TimerWheel::TimerId timer = TimerWheel::instance().schedule(
+                    _ttlMs, &BikeStation::onReservationExpired, this, id);
+        reservations.push_back({id, bike, timer});
+    }
+    endPublish();
+
+    mutex.unlock();
+    return reservation;
+}
+
+Reservation BikeStation::reserveDock(unsigned int _ttlMs) {
+    Reservation reservation;
+
+    mutex.lock();
+
+    if (!endSimulation && claim(freeSlotCount))
+    {
+        beginPublish();
+        reservation.id = nextReservationId++;
+        ++reservedDocks;
+
+        unsigned long long id = reservation.id;
+        TimerWheel::TimerId timer = TimerWheel::instance().schedule(
+                    _ttlMs, &BikeStation::onReservationExpired, this, id);
+        reservations.push_back({id, nullptr, timer});
+
+        endPublish();
+    }
+
+    mutex.unlock();
+    return reservation;
+}
+
+Bike* BikeStation::takeReservedBike(const Reservation& _reservation, size_t _bikeType, bool* _overloaded) {
+    mutex.lock();
+
+    ReservationEntry entry{};
+    bool found = _reservation.valid() && removeReservation(_reservation.id, entry);
+    if (found && !entry.bike)
+    {
+        // Réservation de borne : elle reste active
+        reservations.push_back(entry);
+    }
+    else if (found)
+    {
+        TimerWheel::instance().cancel(entry.timer);
+        beginPublish();
+        --reservedBikes;
+        record(StationLog::Get, StationLog::reservedCounter, -1);
+        endPublish();
+
+        // Une borne se libère
+        releaseSlots(1);
+        slots_available.notifyOne();
+
+        mutex.unlock();
+        return entry.bike;
+    }
+
+    mutex.unlock();
+
+    // Réservation absente ou expirée : chemin normal
+    return getBike(_bikeType, _overloaded);
+}
+
+void BikeStation::putReservedBike(Bike* _bike, const Reservation& _reservation, bool* _overloaded) {
+    if (!_bike) return; // Sécurité
+
+    mutex.lock();
+
+    ReservationEntry entry{};
+    bool found = _reservation.valid() && removeReservation(_reservation.id, entry);
+    if (found && entry.bike)
+    {
+        // Réservation de vélo : elle reste active
+        reservations.push_back(entry);
+    }
+    else if (found)
+    {
+        TimerWheel::instance().cancel(entry.timer);
+        beginPublish();
+        --reservedDocks;
+
+        // La borne réservée est déjà réclamée : pas d'attente
+        if (!endSimulation)
+        {
+            record(StationLog::Put, logCounter(_bike), 1);
+            storeBike(_bike);
+        }
+        else
+        {
+            releaseSlots(1);
+        }
+        endPublish();
+
+        mutex.unlock();
+        return;
+    }
+
+    mutex.unlock();
+
+    // Réservation absente ou expirée : chemin normal
+    putBike(_bike, _overloaded);
+}
+
+void BikeStation::onReservationExpired(void* _station, unsigned long long _id) {
+    static_cast<BikeStation*>(_station)->expireReservation(_id);
+}
+
+void BikeStation::expireReservation(unsigned long long _id) {
+    mutex.lock();
+
+    ReservationEntry entry{};
+    if (removeReservation(_id, entry))
+    {
+        beginPublish();
+        if (entry.bike)
+        {
+            // Le vélo redevient disponible
+            --reservedBikes;
+            record(StationLog::Release, StationLog::reservedCounter, -1);
+            record(StationLog::Release, logCounter(entry.bike), 1);
+            storeBike(entry.bike);
+        }
+        else
+        {
+            // La borne redevient disponible
+            --reservedDocks;
+            releaseSlots(1);
+            slots_available.notifyOne();
+        }
+        endPublish();
+    }
+
+    // Le destructeur attend peut-être cette expiration
+    if (endSimulation)
+        reservation_expired.notifyAll();
+
+    mutex.unlock();
+}
+
+bool BikeStation::removeReservation(unsigned long long _id, ReservationEntry& _entry) {
+    for (size_t i = 0; i < reservations.size(); ++i)
+    {
+        if (reservations[i].id == _id)
+        {
+            _entry = reservations[i];
+            reservations[i] = reservations.back();
+            reservations.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+StationCounts BikeStation::snapshot() const {
+    StationCounts counts;
+    unsigned int before;
+    unsigned int after;
+
+    do {
+        before = sequence.load(std::memory_order_acquire);
+
+        counts.nbBikes = 0;
+        for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+        {
+            counts.bikesOfType[type] = static_cast<size_t>(std::max(0L, available[type].load(std::memory_order_acquire)));
+            counts.nbBikes += counts.bikesOfType[type];
+        }
+        // Lectures en acquire : une valeur écrite pendant une publication implique la séquence impaire
+        counts.nbForMaintenance = publishedMaintenance.load(std::memory_order_acquire);
+        counts.nbReservedBikes = publishedReservedBikes.load(std::memory_order_acquire);
+        counts.nbReservedDocks = publishedReservedDocks.load(std::memory_order_acquire);
+        counts.nbBikes += counts.nbForMaintenance + counts.nbReservedBikes;
+
+        after = sequence.load(std::memory_order_relaxed);
+        // Recommencer si une publication était en cours ou a eu lieu pendant la lecture
+    } while ((before & 1) || before != after);
+
+    // Profondeur des files d'attente : valeurs instantanées
+    for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+        counts.nbWaitingRiders[type] = waitingRiders[type].load(std::memory_order_relaxed);
+    counts.nbWaitingDepositors = waitingDepositors.load(std::memory_order_relaxed);
+    counts.nbOverloaded = overloadedCount.load(std::memory_order_relaxed);
+
+    return counts;
+}
+
 size_t BikeStation::countBikesOfType(size_t type) const {
 
     if (type >= Bike::nbBikeTypes)
         return -1;
 
-    return storage[type].size();
+    return static_cast<size_t>(std::max(0L, available[type].load(std::memory_order_relaxed)));
+}
+
+size_t BikeStation::countBikesForMaintenance() const {
+    return publishedMaintenance.load(std::memory_order_relaxed);
+}
+
+size_t BikeStation::nbBikes() const {
+    return snapshot().nbBikes;
 }
 
 // Pas besoin de lock, utilisé que dans un contexte ou le mutex est déjà lock
-size_t BikeStation::nbBikes() {
+size_t BikeStation::storedBikes() const {
 
-    size_t totalBikes = 0;
+    // Les vélos à réviser et les vélos réservés occupent aussi une borne
+    size_t totalBikes = maintenance.size() + reservedBikes;
 
-    // Récupération du nb d'éléments pour chaque type
+    // Récupération du nb d'éléments pour chaque type (le chemin rapide peut les modifier entre-temps)
     for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
     {
-        totalBikes += storage[type].size();
+        totalBikes += static_cast<size_t>(std::max(0L, available[type].load()));
     }
 
-
     return totalBikes;
 }
 
+// Appelés sous le mutex : les écrivains sont donc déjà sérialisés
+void BikeStation::beginPublish() {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void BikeStation::endPublish() {
+    // Écritures en release (comme les modifications seq_cst des compteurs par type) :
+    // un lecteur qui voit une nouvelle valeur voit aussi la séquence impaire
+    publishedMaintenance.store(maintenance.size(), std::memory_order_release);
+    publishedReservedBikes.store(reservedBikes, std::memory_order_release);
+    publishedReservedDocks.store(reservedDocks, std::memory_order_release);
+
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+StationLog::Utilisation BikeStation::utilisation() {
+    return history.utilisation();
+}
+
+StationLog::State BikeStation::stateAt(unsigned long long _timeMs) {
+    return history.stateAt(_timeMs);
+}
+
+void BikeStation::trackImbalance(ImbalanceIndex* _index, unsigned int _site) {
+    mutex.lock();
+    imbalance = _index;
+    imbalanceSite = _site;
+    if (imbalance) {
+        imbalance->set(imbalanceSite, storedBikes() - maintenance.size());
+        imbalance->setWorn(imbalanceSite, maintenance.size());
+    }
+    mutex.unlock();
+}
+
+void BikeStation::record(StationLog::Kind _kind, unsigned int _counter, long _delta) {
+    history.append(_kind, _counter, _delta);
+
+    // Vélos à réviser comptés à part : le van les retire avant d'équilibrer le site
+    if (!imbalance)
+        return;
+    if (_counter == StationLog::maintenanceCounter)
+        imbalance->addWorn(imbalanceSite, _delta);
+    else
+        imbalance->add(imbalanceSite, _delta);
+}
+
 size_t BikeStation::nbSlots() {
     return capacity;
 }
 
+size_t BikeStation::nbFreeSlots() const {
+    return static_cast<size_t>(std::max(0L, freeSlotCount.load(std::memory_order_relaxed)));
+}
+
+void BikeStation::freeze() {
+    mutex.lock();
+
+    // Fermer le chemin rapide puis attendre que les opérations en cours s'y terminent
+    fastPathClosed.store(true, std::memory_order_seq_cst);
+    while (fastPathUsers.load(std::memory_order_seq_cst) != 0)
+        std::this_thread::yield();
+}
+
+void BikeStation::thaw() {
+    fastPathClosed.store(false, std::memory_order_release);
+    mutex.unlock();
+}
+
+std::vector<Bike*> BikeStation::dockedBikes() const {
+    std::vector<Bike*> bikes;
+
+    for (const auto& bikesOfType : storage)
+        bikesOfType.forEach([&bikes](Bike* _bike) { bikes.push_back(_bike); });
+    bikes.insert(bikes.end(), maintenance.begin(), maintenance.end());
+    for (const ReservationEntry& reservation : reservations)
+        if (reservation.bike)
+            bikes.push_back(reservation.bike);
+
+    return bikes;
+}
+
 void BikeStation::ending() {
     mutex.lock();
 
@@ -7,8 +7,11 @@ using namespace std;
 #include <QMessageBox>
 #include <QThread>
 
+#include <algorithm>
+
 bool BikingInterface::sm_didInitialize=false;
 MainWindow *BikingInterface::mainWindow=0;
+unsigned int BikingInterface::sm_nbSites=0;
 
 BikingInterface::BikingInterface()
 {
@@ -20,37 +23,44 @@ BikingInterface::BikingInterface()
         exit(-1);
     }
 
-    QObject::connect(this,
-                     SIGNAL(sig_consoleAppendText(unsigned int,QString)),
-                     mainWindow,
-                     SLOT(consoleAppendText(unsigned int,QString)));
-    QObject::connect(this,
-                     SIGNAL(sig_setBikes(unsigned int,unsigned int)),
-                     mainWindow,
-                     SLOT(setBikes(unsigned int,unsigned int)));
-    QObject::connect(this,
-                     SIGNAL(sig_travel(unsigned int,unsigned int,unsigned int,unsigned int)),
-                     mainWindow,
-                     SLOT(travel(unsigned int,unsigned int,unsigned int,unsigned int)));
-    QObject::connect(this,
-                     SIGNAL(sig_vanTravel(unsigned int,unsigned int,
-                                          unsigned int)),
-                     mainWindow,
-                     SLOT(vanTravel(unsigned int,unsigned int,unsigned int)));
-    QObject::connect(this,
-                     SIGNAL(sig_walk(unsigned int,unsigned int,unsigned int,unsigned int)),
-                     mainWindow,
-                     SLOT(walk(unsigned int,unsigned int,unsigned int,unsigned int)));
+    // Une case par événement en attente ; le vidage se fait dans le thread graphique
+    m_events.allocate(GUI_EVENT_QUEUE_SIZE);
+    m_bikes = std::make_unique<std::atomic<unsigned int>[]>(sm_nbSites + 1);
+    m_bikesChanged = std::make_unique<std::atomic<bool>[]>(sm_nbSites + 1);
+    QObject::connect(&m_drainTimer, &QTimer::timeout,
+                     this, &BikingInterface::drainEvents);
+    m_drainTimer.start(GUI_DRAIN_PERIOD_MS);
 }
 
 
-#include <QTest>
+#include "timerwheel.h"
+
+// Les durées sont en temps simulé : l'animation dure le temps réel
+// correspondant et l'attente passe par la roue temporelle.
+
+void BikingInterface::post(const GuiEvent &event)
+{
+    // Le journal laisse la réserve aux déplacements, qui ne seraient sinon jamais animés
+    if (event.kind == GuiEvent::Log
+        && m_events.sizeApprox() + GUI_EVENT_RESERVED >= m_events.capacity()) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (!m_events.tryPush(event))
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
 
 void BikingInterface::travel(unsigned int personId,unsigned int site1, unsigned int site2,
                              unsigned int ms)
 {
-    emit sig_travel(personId,site1,site2,ms);
-    QTest::qSleep(ms);
+    GuiEvent event;
+    event.kind = GuiEvent::Travel;
+    event.args[0] = personId;
+    event.args[1] = site1;
+    event.args[2] = site2;
+    event.args[3] = TimerWheel::instance().toRealMs(ms);
+    post(event);
+    TimerWheel::instance().sleepFor(ms);
 }
 
 void BikingInterface::walk(unsigned int personId,
@@ -58,23 +68,106 @@ void BikingInterface::walk(unsigned int personId,
                            unsigned int site2,
                            unsigned int ms)
 {
-    emit sig_walk(personId, site1, site2, ms);
-    QTest::qSleep(ms);
+    GuiEvent event;
+    event.kind = GuiEvent::Walk;
+    event.args[0] = personId;
+    event.args[1] = site1;
+    event.args[2] = site2;
+    event.args[3] = TimerWheel::instance().toRealMs(ms);
+    post(event);
+    TimerWheel::instance().sleepFor(ms);
 }
 
 void BikingInterface::vanTravel(unsigned int site1, unsigned int site2,
                                 unsigned int ms)
 {
-    emit sig_vanTravel(site1,site2,ms);
-    QTest::qSleep(ms);
+    GuiEvent event;
+    event.kind = GuiEvent::VanTravel;
+    event.args[0] = site1;
+    event.args[1] = site2;
+    event.args[2] = TimerWheel::instance().toRealMs(ms);
+    post(event);
+    TimerWheel::instance().sleepFor(ms);
 }
 
 void BikingInterface::consoleAppendText(unsigned int consoleId,QString text) {
-    emit sig_consoleAppendText(consoleId,text);
+    GuiEvent event;
+    event.kind = GuiEvent::Log;
+    event.record.entity = consoleId;
+    event.record.message = LogMessage::Text;
+    event.record.timeMs = TimerWheel::instance().nowMs();
+
+    // Copie des unités UTF-16 sans allocation ; une paire de substitution coupée est retirée
+    size_t length = std::min<size_t>(text.size(), GUI_EVENT_TEXT_LENGTH);
+    const QChar *chars = text.constData();
+    if (length == GUI_EVENT_TEXT_LENGTH && length < static_cast<size_t>(text.size())
+        && chars[length - 1].isHighSurrogate())
+        --length;
+    for (size_t i = 0; i < length; ++i)
+        event.text[i] = chars[i].unicode();
+    event.length = static_cast<unsigned short>(length);
+    post(event);
+}
+
+void BikingInterface::log(unsigned int entityId,LogMessage message,
+                          long long arg0,long long arg1,long long arg2) {
+    GuiEvent event;
+    event.kind = GuiEvent::Log;
+    event.record.entity = entityId;
+    event.record.message = message;
+    event.record.timeMs = TimerWheel::instance().nowMs();
+    event.record.args[0] = arg0;
+    event.record.args[1] = arg1;
+    event.record.args[2] = arg2;
+    event.length = 0;
+    post(event);
 }
 
 void BikingInterface::setBikes(unsigned int site,unsigned int nbBike) {
-    emit sig_setBikes(site,nbBike);
+    // Seule la dernière valeur compte : elle remplace celle que le vidage n'a pas encore prise.
+    // release : le vidage qui voit l'indicateur voit la valeur écrite avant
+    m_bikes[site].store(nbBike, std::memory_order_relaxed);
+    m_bikesChanged[site].store(true, std::memory_order_release);
+}
+
+void BikingInterface::drainEvents()
+{
+    // Au plus une file pleine par vidage : des threads plus rapides ne bloquent pas l'interface
+    GuiEvent event;
+    for (size_t i = 0; i < GUI_EVENT_QUEUE_SIZE && m_events.tryPop(event); ++i) {
+        switch (event.kind) {
+        case GuiEvent::Log:
+            mainWindow->appendLog(event.record,
+                                  event.record.message == LogMessage::Text
+                                      ? QString::fromUtf16(event.text, event.length)
+                                      : QString());
+            break;
+        case GuiEvent::Travel:
+            mainWindow->travel(event.args[0], event.args[1], event.args[2], event.args[3]);
+            break;
+        case GuiEvent::Walk:
+            mainWindow->walk(event.args[0], event.args[1], event.args[2], event.args[3]);
+            break;
+        case GuiEvent::VanTravel:
+            mainWindow->vanTravel(event.args[0], event.args[1], event.args[2]);
+            break;
+        }
+    }
+
+    // Un site modifié après l'échange relève son indicateur : il sera repris au vidage suivant
+    for (unsigned int site = 0; site <= sm_nbSites; ++site) {
+        if (m_bikesChanged[site].exchange(false, std::memory_order_acquire))
+            mainWindow->setBikes(site, m_bikes[site].load(std::memory_order_relaxed));
+    }
+
+    unsigned long long dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        LogRecord record;
+        record.message = LogMessage::EventsDropped;
+        record.timeMs = TimerWheel::instance().nowMs();
+        record.args[0] = static_cast<std::int64_t>(dropped);
+        mainWindow->appendLog(record, QString());
+    }
 }
 
 void BikingInterface::setInitBikes(unsigned int site,unsigned int nbBike) {
@@ -95,6 +188,7 @@ void BikingInterface::initialize(unsigned int nbConsoles,unsigned int nbSites)
                              "qu'une seule fois");
         return;
     }
+    sm_nbSites=nbSites;
     mainWindow= new MainWindow(nbConsoles,nbSites,0);
     mainWindow->show();
     sm_didInitialize=true;
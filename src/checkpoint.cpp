@@ -0,0 +1,328 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : checkpoint.cpp
+ * Sauvegarde et reprise de l'état complet de la simulation : vélos (usure comprise), contenu des
+ * stations, position et chargement du van, position des personnes et état de leurs générateurs
+ * aléatoires. Les agents publient leur état à chaque point de quiescence (avant et après chaque
+ * attente) ; une sauvegarde ne fait attendre que les agents actifs, le temps de copier l'état.
+ */
+
+#include "checkpoint.h"
+#include "timerwheel.h"
+#include "vancargo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+namespace {
+
+const char MAGIC[8] = {'P', 'C', 'O', 'C', 'K', 'P', 'T', '\0'};
+const std::uint32_t VERSION = 1;
+
+// Écriture et lecture binaires de valeurs de taille fixe
+template<typename T>
+void put(std::ostream& _out, T _value)
+{
+    _out.write(reinterpret_cast<const char*>(&_value), sizeof(T));
+}
+
+template<typename T>
+bool get(std::istream& _in, T& _value)
+{
+    return static_cast<bool>(_in.read(reinterpret_cast<char*>(&_value), sizeof(T)));
+}
+
+void putIds(std::ostream& _out, const std::vector<unsigned int>& _ids)
+{
+    put<std::uint32_t>(_out, static_cast<std::uint32_t>(_ids.size()));
+    for (unsigned int id : _ids)
+        put<std::uint32_t>(_out, id);
+}
+
+bool getIds(std::istream& _in, std::vector<unsigned int>& _ids)
+{
+    std::uint32_t n;
+    if (!get(_in, n))
+        return false;
+    _ids.resize(n);
+    for (auto& id : _ids) {
+        std::uint32_t value;
+        if (!get(_in, value))
+            return false;
+        id = value;
+    }
+    return true;
+}
+
+} // namespace
+
+Checkpoint& Checkpoint::instance() {
+    static Checkpoint checkpoint;
+    return checkpoint;
+}
+
+Checkpoint::Slot* Checkpoint::registerAgent(const AgentState& _state) {
+    mutex.lock();
+    slots.push_back(std::make_unique<Slot>());
+    Slot* slot = slots.back().get();
+    slot->state = _state;
+    mutex.unlock();
+    return slot;
+}
+
+void Checkpoint::leave(Slot* _slot, const AgentState& _state) {
+    _slot->mutex.lock();
+    _slot->state = _state;
+    _slot->mutex.unlock();
+    _slot->status.store(Away);
+
+    // Une sauvegarde attend peut-être cet agent
+    if (requested.load()) {
+        mutex.lock();
+        agentChanged.notifyAll();
+        mutex.unlock();
+    }
+}
+
+void Checkpoint::arrive(Slot* _slot, const AgentState& _state) {
+    _slot->mutex.lock();
+    _slot->state = _state;
+    _slot->mutex.unlock();
+
+    // Dekker : soit l'agent voit la demande, soit la sauvegarde le voit présent
+    _slot->status.store(Present);
+    if (requested.load()) {
+        mutex.lock();
+        while (requested.load()) {
+            _slot->status.store(Parked);
+            agentChanged.notifyAll();
+            released.wait(&mutex);
+        }
+        _slot->status.store(Present);
+        mutex.unlock();
+    }
+}
+
+void Checkpoint::finish(Slot* _slot) {
+    mutex.lock();
+    _slot->status.store(Finished);
+    agentChanged.notifyAll();
+    mutex.unlock();
+}
+
+bool Checkpoint::quiescent() const {
+    for (const auto& slot : slots) {
+        if (slot->status.load() == Present)
+            return false;
+    }
+    return true;
+}
+
+bool Checkpoint::save(const std::string& _path,
+                      const std::array<BikeStation*, NB_SITES_TOTAL>& _stations,
+                      const std::vector<Bike*>& _fleet) {
+    SimulationState state;
+
+    mutex.lock();
+    requested.store(true);
+
+    // Attendre que les agents actifs atteignent un point de quiescence
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CHECKPOINT_TIMEOUT_MS);
+    while (!quiescent() && std::chrono::steady_clock::now() < deadline) {
+        agentChanged.waitForSeconds(&mutex, 1);
+    }
+
+    // Un agent encore actif pourrait tenir un vélo que ni lui ni une station ne déclare : abandon
+    if (!quiescent()) {
+        requested.store(false);
+        released.notifyAll();
+        mutex.unlock();
+        return false;
+    }
+
+    // Coupe cohérente des stations : toutes verrouillées ensemble, dans l'ordre
+    for (BikeStation* station : _stations)
+        if (station)
+            station->freeze();
+
+    state.simTimeMs = TimerWheel::instance().nowMs();
+    for (size_t s = 0; s < NB_SITES_TOTAL; ++s) {
+        if (!_stations[s])
+            continue;
+        for (Bike* bike : _stations[s]->dockedBikes())
+            state.stations[s].push_back(bike->id);
+    }
+
+    // Usure des vélos : seul un agent présent la modifie, aucun ne l'est tant qu'ils sont retenus
+    for (Bike* bike : _fleet) {
+        state.bikes.push_back({bike->id, static_cast<unsigned int>(bike->bikeType),
+                               static_cast<unsigned int>(bike->nbRides), bike->totalRideTimeMs,
+                               static_cast<unsigned int>(bike->ridesSinceService),
+                               bike->needsMaintenance});
+    }
+
+    for (BikeStation* station : _stations)
+        if (station)
+            station->thaw();
+
+    for (const auto& slot : slots) {
+        slot->mutex.lock();
+        state.agents.push_back(slot->state);
+        slot->mutex.unlock();
+    }
+
+    requested.store(false);
+    released.notifyAll();
+    mutex.unlock();
+
+    // Réconciliation : les stations font foi, puis les agents, le reste va au dépôt
+    std::unordered_set<unsigned int> placed;
+    for (const auto& docked : state.stations)
+        placed.insert(docked.begin(), docked.end());
+
+    for (AgentState& agent : state.agents) {
+        std::vector<unsigned int> held;
+        for (unsigned int id : agent.bikes) {
+            if (placed.insert(id).second)
+                held.push_back(id);
+        }
+        agent.bikes = std::move(held);
+    }
+
+    for (const BikeRecord& bike : state.bikes) {
+        if (placed.insert(bike.id).second)
+            state.stations[DEPOT_ID].push_back(bike.id);
+    }
+
+    // Écriture du fichier, hors de tout verrou
+    std::ofstream out(_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    out.write(MAGIC, sizeof(MAGIC));
+    put<std::uint32_t>(out, VERSION);
+    put<std::uint32_t>(out, NB_SITES_TOTAL);
+    put<std::uint64_t>(out, state.simTimeMs);
+
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(state.bikes.size()));
+    for (const BikeRecord& bike : state.bikes) {
+        put<std::uint32_t>(out, bike.id);
+        put<std::uint8_t>(out, static_cast<std::uint8_t>(bike.bikeType));
+        put<std::uint32_t>(out, bike.nbRides);
+        put<std::uint64_t>(out, bike.totalRideTimeMs);
+        put<std::uint32_t>(out, bike.ridesSinceService);
+        put<std::uint8_t>(out, bike.needsMaintenance ? 1 : 0);
+    }
+
+    for (const auto& docked : state.stations)
+        putIds(out, docked);
+
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(state.agents.size()));
+    for (const AgentState& agent : state.agents) {
+        put<std::uint8_t>(out, agent.kind);
+        put<std::uint32_t>(out, agent.id);
+        put<std::uint32_t>(out, agent.site);
+        put<std::uint32_t>(out, agent.homeSite);
+        put<std::uint32_t>(out, agent.preferredType);
+        putIds(out, agent.bikes);
+        for (std::uint64_t word : agent.rng)
+            put<std::uint64_t>(out, word);
+    }
+
+    return static_cast<bool>(out);
+}
+
+bool Checkpoint::load(const std::string& _path, SimulationState& _state) {
+    std::ifstream in(_path, std::ios::binary);
+    if (!in)
+        return false;
+
+    char magic[sizeof(MAGIC)];
+    std::uint32_t version;
+    std::uint32_t nbStations;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+            || !get(in, version) || version != VERSION
+            || !get(in, nbStations) || nbStations != NB_SITES_TOTAL)
+        return false;
+
+    SimulationState state;
+    std::uint64_t simTime;
+    std::uint32_t nbBikes;
+    if (!get(in, simTime) || !get(in, nbBikes))
+        return false;
+    state.simTimeMs = simTime;
+
+    state.bikes.resize(nbBikes);
+    for (BikeRecord& bike : state.bikes) {
+        std::uint32_t id, nbRides, sinceService;
+        std::uint8_t type, flagged;
+        std::uint64_t rideTime;
+        if (!get(in, id) || !get(in, type) || !get(in, nbRides) || !get(in, rideTime)
+                || !get(in, sinceService) || !get(in, flagged) || type >= Bike::nbBikeTypes)
+            return false;
+        bike = {id, type, nbRides, rideTime, sinceService, flagged != 0};
+    }
+
+    for (auto& docked : state.stations)
+        if (!getIds(in, docked))
+            return false;
+
+    std::uint32_t nbAgents;
+    if (!get(in, nbAgents))
+        return false;
+    state.agents.resize(nbAgents);
+    for (AgentState& agent : state.agents) {
+        std::uint8_t kind;
+        std::uint32_t id, site, home, type;
+        if (!get(in, kind) || kind > AgentState::VanAgent || !get(in, id) || !get(in, site) || !get(in, home) || !get(in, type)
+                || !getIds(in, agent.bikes) || site >= NB_SITES_TOTAL || home >= NB_SITES_TOTAL
+                || type >= Bike::nbBikeTypes)
+            return false;
+        agent.kind = static_cast<AgentState::Kind>(kind);
+        agent.id = id;
+        agent.site = site;
+        agent.homeSite = home;
+        agent.preferredType = type;
+        for (auto& word : agent.rng) {
+            std::uint64_t value;
+            if (!get(in, value))
+                return false;
+            word = value;
+        }
+        if (agent.kind == AgentState::PersonAgent && (site >= NBSITES || home >= NBSITES))
+            return false;
+
+        // Une personne tient au plus un vélo, le van au plus son chargement
+        const size_t maxHeld = (agent.kind == AgentState::VanAgent) ? VanCargo::capacity : 1;
+        if (agent.bikes.size() > maxHeld)
+            return false;
+    }
+
+    // Identifiants uniques, et chaque vélo référencé existe et n'est placé qu'une fois
+    std::unordered_set<unsigned int> known;
+    for (const BikeRecord& bike : state.bikes)
+        if (!known.insert(bike.id).second)
+            return false;
+    std::unordered_set<unsigned int> placed;
+    auto placeAll = [&known, &placed](const std::vector<unsigned int>& _ids) {
+        return std::all_of(_ids.begin(), _ids.end(), [&known, &placed](unsigned int _id) {
+            return known.count(_id) != 0 && placed.insert(_id).second;
+        });
+    };
+    for (const auto& docked : state.stations)
+        if (!placeAll(docked))
+            return false;
+    for (const AgentState& agent : state.agents)
+        if (!placeAll(agent.bikes))
+            return false;
+
+    _state = std::move(state);
+    return true;
+}
@@ -0,0 +1,133 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : demandmodel.cpp
+ * Cette classe représente la demande des usagers sous forme de matrices origine-destination,
+ * une par période de la journée simulée. Pour chaque période et chaque site d'origine,
+ * une table d'alias (méthode de Vose) permet de tirer une destination en temps constant.
+ */
+
+#include "demandmodel.h"
+#include "timerwheel.h"
+
+#include <fstream>
+#include <sstream>
+
+DemandModel::DemandModel() {
+    std::array<double, NBSITES> uniform;
+    uniform.fill(1.0);
+
+    Profile profile;
+    for (unsigned int from = 0; from < NBSITES; ++from) {
+        buildTable(from, uniform, profile[from]);
+    }
+    profiles.push_back(profile);
+}
+
+bool DemandModel::loadFromFile(const std::string& _path) {
+    std::ifstream file(_path);
+    if (!file)
+        return false;
+
+    std::vector<std::array<double, NBSITES>> rows;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream in(line);
+        std::array<double, NBSITES> row{};
+        for (size_t to = 0; to < NBSITES; ++to) {
+            if (!(in >> row[to]) || row[to] < 0.0)
+                return false;
+        }
+        rows.push_back(row);
+    }
+
+    // Il faut un nombre entier de matrices NBSITES x NBSITES
+    if (rows.empty() || rows.size() % NBSITES != 0)
+        return false;
+
+    std::vector<Profile> loaded(rows.size() / NBSITES);
+    for (size_t p = 0; p < loaded.size(); ++p) {
+        for (unsigned int from = 0; from < NBSITES; ++from) {
+            buildTable(from, rows[p * NBSITES + from], loaded[p][from]);
+        }
+    }
+
+    profiles = std::move(loaded);
+    return true;
+}
+
+size_t DemandModel::currentProfile() const {
+    unsigned long long timeOfDay = TimerWheel::instance().nowMs() % SIM_DAY_MS;
+    return static_cast<size_t>(timeOfDay * profiles.size() / SIM_DAY_MS);
+}
+
+unsigned int DemandModel::sample(unsigned int _from, size_t _profile) const {
+    const AliasTable& table = profiles[_profile][_from];
+
+    unsigned int i = c_rng.below(NBSITES);
+    return c_rng.nextFloat() < table.prob[i] ? i : table.alias[i];
+}
+
+void DemandModel::buildTable(unsigned int _from,
+                             const std::array<double, NBSITES>& _weights,
+                             AliasTable& _table) {
+    std::array<double, NBSITES> weights = _weights;
+    weights[_from] = 0.0; // Jamais de trajet vers le site de départ
+
+    double total = 0.0;
+    for (double w : weights)
+        total += w;
+
+    // Origine sans demande : choix uniforme parmi les autres sites
+    if (total <= 0.0) {
+        weights.fill(1.0);
+        weights[_from] = 0.0;
+        total = NBSITES - 1;
+    }
+
+    // Méthode de Vose : probabilités normalisées à une moyenne de 1
+    std::array<double, NBSITES> scaled;
+    std::vector<unsigned int> small;
+    std::vector<unsigned int> large;
+    for (unsigned int i = 0; i < NBSITES; ++i) {
+        scaled[i] = weights[i] * NBSITES / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+        unsigned int s = small.back();
+        small.pop_back();
+        unsigned int l = large.back();
+
+        _table.prob[s] = static_cast<float>(scaled[s]);
+        _table.alias[s] = l;
+
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Colonnes restantes : probabilité 1 (aux erreurs d'arrondi près)
+    for (unsigned int i : large) {
+        _table.prob[i] = 1.0f;
+        _table.alias[i] = i;
+    }
+    for (unsigned int i : small) {
+        _table.prob[i] = 1.0f;
+        _table.alias[i] = i;
+    }
+
+    // Le site de départ ne doit jamais être tiré, même par arrondi
+    if (_table.alias[_from] == _from) {
+        _table.prob[_from] = 0.0f;
+        _table.alias[_from] = _from == 0 ? 1 : 0;
+    }
+    _table.prob[_from] = 0.0f;
+}
@@ -7,16 +7,14 @@
   ****************************************************************************/
 
 #include "display.h"
+#include "sitemap.h"
 
 #include <QPaintEvent>
 #include <QPainter>
 
-#include <QParallelAnimationGroup>
-#include <QPropertyAnimation>
-#include <QEventLoop>
-#include <QMutex>
 
 
+#include <algorithm>
 #include <cmath>
 
 #define RADIUS 250.0
@@ -28,25 +26,47 @@
 
 #define NBPERSONICONS 30
 
+// Période du tic d'animation (ms réelles)
+#define FRAMEMS 16
+
 BikeItem::BikeItem() = default;
 
 PersonItem::PersonItem() = default;
 
-BikeDisplay::BikeDisplay(unsigned int nbSite,QWidget *parent):
+BikeDisplay::BikeDisplay(unsigned int nbSite,const SiteMap *siteMap,
+                         QWidget *parent):
     QGraphicsView(parent)
 {
     m_sitePos=new QPointF[nbSite+1];
-    for(unsigned int i=0;i<nbSite;i++)
-    {
-        m_sitePos[i]=
-                QPointF(SCENEOFFSET+RADIUS+RADIUS*cos(2.0*3.14/((float)nbSite)
-                                                      *((float)i)),
-                        SCENEOFFSET+RADIUS+RADIUS*sin(2.0*3.14/((float)nbSite)
-                                                      *((float)i)));
+    if (siteMap && nbSite==NBSITES) {
+        // Mise à l'échelle des coordonnées réelles dans la scène
+        double minX=siteMap->x(0),maxX=minX,minY=siteMap->y(0),maxY=minY;
+        for(unsigned int i=1;i<=nbSite;i++) {
+            minX=std::min(minX,siteMap->x(i));
+            maxX=std::max(maxX,siteMap->x(i));
+            minY=std::min(minY,siteMap->y(i));
+            maxY=std::max(maxY,siteMap->y(i));
+        }
+        double extent=std::max(maxX-minX,maxY-minY);
+        double scale=(extent>0.0)?(2*RADIUS/extent):1.0;
+        for(unsigned int i=0;i<=nbSite;i++) {
+            m_sitePos[i]=QPointF(SCENEOFFSET+(siteMap->x(i)-minX)*scale,
+                                 SCENEOFFSET+(siteMap->y(i)-minY)*scale);
+        }
+    }
+    else {
+        for(unsigned int i=0;i<nbSite;i++)
+        {
+            m_sitePos[i]=
+                    QPointF(SCENEOFFSET+RADIUS+RADIUS*cos(2.0*3.14/((float)nbSite)
+                                                          *((float)i)),
+                            SCENEOFFSET+RADIUS+RADIUS*sin(2.0*3.14/((float)nbSite)
+                                                          *((float)i)));
+        }
+        m_sitePos[nbSite]=
+                QPointF(SCENEOFFSET+RADIUS,
+                        SCENEOFFSET+RADIUS);
     }
-    m_sitePos[nbSite]=
-            QPointF(SCENEOFFSET+RADIUS,
-                    SCENEOFFSET+RADIUS);
     m_scene=new QGraphicsScene(this);
     this->setRenderHints(QPainter::Antialiasing |
                          QPainter::SmoothPixmapTransform);
@@ -80,6 +100,12 @@ BikeDisplay::BikeDisplay(unsigned int nbSite,QWidget *parent):
     m_van->setPixmap(vanPixmap);
     m_scene->addItem(m_van);
     m_van->setPos(m_sitePos[nbSite]);
+
+    // Un seul tic fait avancer tous les trajets en cours
+    m_clock.start();
+    m_frameTimer.setInterval(FRAMEMS);
+    QObject::connect(&m_frameTimer, &QTimer::timeout,
+                     this, &BikeDisplay::advanceTrips);
 }
 
 
@@ -113,19 +139,10 @@ void BikeDisplay::setFreeBike(BikeItem *bike)
 void BikeDisplay::vanTravel(unsigned int site1,unsigned int site2,
                             unsigned int ms)
 {
-    static QMutex mutex;
-    mutex.lock();
     m_van->show();
-    auto *animation=new QPropertyAnimation(m_van, "pos");
-    animation->setDuration(ms-10);
-    animation->setStartValue(m_sitePos[site1]-QPointF(VANWIDTH/2,VANWIDTH/2));
-    animation->setEndValue(m_sitePos[site2]-QPointF(VANWIDTH/2,VANWIDTH/2));
-    animation->start();
-
-    QObject::connect(animation, SIGNAL(finished()), this,
-                     SLOT(finishedVanAnimation()));
-
-    mutex.unlock();
+    startTrip(Trip::VanTrip,m_van,
+              m_sitePos[site1]-QPointF(VANWIDTH/2,VANWIDTH/2),
+              m_sitePos[site2]-QPointF(VANWIDTH/2,VANWIDTH/2),ms);
 }
 
 void BikeDisplay::walk(unsigned int personId,
@@ -133,36 +150,11 @@ void BikeDisplay::walk(unsigned int personId,
                        unsigned int site2,
                        unsigned int ms)
 {
-    static QMutex mutex;
-    mutex.lock();
-
-    auto *group = new QParallelAnimationGroup(this);
-
-    {
-        PersonItem *person = getPerson(personId);
-        person->show();
-        auto *animation = new QPropertyAnimation(person, "pos");
-        animation->setDuration(ms - 10);
-        animation->setStartValue(m_sitePos[site1] -
-                                 QPointF(BIKEWIDTH/2, BIKEWIDTH*1.2));
-        animation->setEndValue(m_sitePos[site2] -
-                               QPointF(BIKEWIDTH/2, BIKEWIDTH*1.2));
-        group->addAnimation(animation);
-    }
-
-    group->start();
-
-    QObject::connect(group, SIGNAL(finished()), this,
-                     SLOT(finishedAnimation()));
-
-    mutex.unlock();
-}
-
-
-void BikeDisplay::finishedVanAnimation()
-{
-    auto *animation=dynamic_cast<QPropertyAnimation*>(sender());
-    delete animation;
+    PersonItem *person = getPerson(personId);
+    person->show();
+    startTrip(Trip::PersonTrip,person,
+              m_sitePos[site1]-QPointF(BIKEWIDTH/2,BIKEWIDTH*1.2),
+              m_sitePos[site2]-QPointF(BIKEWIDTH/2,BIKEWIDTH*1.2),ms);
 }
 
 void BikeDisplay::setBikes(unsigned int site,unsigned int nbBike)
@@ -217,63 +209,62 @@ PersonItem *BikeDisplay::getPerson(unsigned int personId)
 
 void BikeDisplay::travel(unsigned int personId,unsigned int site1, unsigned int site2,unsigned int ms)
 {
-    static QMutex mutex;
-    mutex.lock();
-
-
-    auto *group=new QParallelAnimationGroup(this);
-
-    {
-        BikeItem *bike=getFreeBike();
-        bike->show();
-        auto *animation=new QPropertyAnimation(bike, "pos");
-        animation->setDuration(ms-10);
-        animation->setStartValue(m_sitePos[site1]-
-                                 QPointF(BIKEWIDTH/2,BIKEWIDTH/2));
-        animation->setEndValue(m_sitePos[site2]-
-                               QPointF(BIKEWIDTH/2,BIKEWIDTH/2));
-
-        group->addAnimation(animation);
-    }
-    {
-        PersonItem *person=getPerson(personId);
-        person->show();
-        auto *animation=new QPropertyAnimation(person, "pos");
-        animation->setDuration(ms-10);
-        animation->setStartValue(m_sitePos[site1]-
-                                 QPointF(BIKEWIDTH/2,BIKEWIDTH*1.2));
-        animation->setEndValue(m_sitePos[site2]-
-                               QPointF(BIKEWIDTH/2,BIKEWIDTH*1.2));
-
-        group->addAnimation(animation);
-    }
+    BikeItem *bike=getFreeBike();
+    bike->show();
+    startTrip(Trip::BikeTrip,bike,
+              m_sitePos[site1]-QPointF(BIKEWIDTH/2,BIKEWIDTH/2),
+              m_sitePos[site2]-QPointF(BIKEWIDTH/2,BIKEWIDTH/2),ms);
 
-    group->start();
-
-    QObject::connect(group, SIGNAL(finished()), this,
-                     SLOT(finishedAnimation()));
+    PersonItem *person=getPerson(personId);
+    person->show();
+    startTrip(Trip::PersonTrip,person,
+              m_sitePos[site1]-QPointF(BIKEWIDTH/2,BIKEWIDTH*1.2),
+              m_sitePos[site2]-QPointF(BIKEWIDTH/2,BIKEWIDTH*1.2),ms);
+}
 
-    mutex.unlock();
+void BikeDisplay::startTrip(Trip::Kind kind,QGraphicsPixmapItem *item,QPointF from,
+                            QPointF to,unsigned int ms)
+{
+    // Même marge que les anciennes animations : le trajet finit juste avant le réveil du thread
+    qint64 duration=(ms>10)?ms-10:0;
+    item->setPos(from);
+    m_trips.push_back(Trip{kind,item,from,to,m_clock.elapsed(),duration});
+    if (!m_frameTimer.isActive())
+        m_frameTimer.start();
 }
 
-void BikeDisplay::finishedAnimation()
+void BikeDisplay::advanceTrips()
 {
-    auto *group=dynamic_cast<QParallelAnimationGroup*>(sender());
-    for(int i=0;i<group->animationCount();i++) {
-        auto *animation=dynamic_cast<QPropertyAnimation*>(group->animationAt(i));
-        auto *bike=dynamic_cast<BikeItem*>(animation->targetObject());
-        if (bike) {
+    qint64 now=m_clock.elapsed();
+
+    for(size_t i=0;i<m_trips.size();) {
+        Trip &trip=m_trips[i];
+        qint64 elapsed=now-trip.startMs;
+        if (elapsed<trip.durationMs) {
+            double t=double(elapsed)/double(trip.durationMs);
+            trip.item->setPos(trip.from+(trip.to-trip.from)*t);
+            i++;
+            continue;
+        }
+
+        // Trajet terminé : le vélo retourne à la réserve, la personne se place autour du site
+        trip.item->setPos(trip.to);
+        if (trip.kind==Trip::BikeTrip) {
+            auto *bike=static_cast<BikeItem*>(trip.item);
             bike->hide();
             setFreeBike(bike);
         }
-        auto *person=dynamic_cast<PersonItem*>(animation->targetObject());
-        if (person) {
-            QPointF curPos = person->pos()+ QPointF(BIKEWIDTH/2,BIKEWIDTH*1.2);
+        else if (trip.kind==Trip::PersonTrip) {
+            QPointF curPos = trip.to + QPointF(BIKEWIDTH/2,BIKEWIDTH*1.2);
             float angle = rand();
-            person->setPos(curPos.x() + 40*cos(angle),curPos.y() + 40*sin(angle));
+            trip.item->setPos(curPos.x() + 40*cos(angle),curPos.y() + 40*sin(angle));
         }
-    }
-    delete group;
-}
 
+        // Retrait sans décalage : le dernier trajet prend la place
+        trip=m_trips.back();
+        m_trips.pop_back();
+    }
 
+    if (m_trips.empty())
+        m_frameTimer.stop();
+}
@@ -0,0 +1,160 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : imbalanceindex.cpp
+ * Index global du déséquilibre des sites : mises à jour sans verrou des feuilles, report paresseux
+ * des chemins modifiés dans l'arbre de segments et requêtes des k sites les plus déséquilibrés.
+ */
+
+#include "imbalanceindex.h"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <queue>
+
+namespace {
+
+// Valeurs neutres des feuilles de remplissage : jamais choisies
+const long NO_MIN = LONG_MAX;
+const long NO_MAX = LONG_MIN;
+
+} // namespace
+
+ImbalanceIndex::ImbalanceIndex(size_t _nbSites, long _target)
+    : count(_nbSites), goal(_target) {
+    while (size < count)
+        size <<= 1;
+
+    leaves = std::make_unique<Leaf[]>(count);
+    nbDirtyWords = (count + 63) / 64;
+    dirty = std::make_unique<std::atomic<std::uint64_t>[]>(nbDirtyWords);
+
+    // Stock nul partout : chaque site réel est à -target, le remplissage est neutre
+    tree.assign(2 * size, Node{NO_MIN, NO_MAX, 0});
+    for (size_t s = 0; s < count; ++s)
+        tree[size + s] = Node{-goal, -goal, 0};
+    for (size_t i = size - 1; i > 0; --i)
+        tree[i] = merge(tree[2 * i], tree[2 * i + 1]);
+}
+
+ImbalanceIndex::Node ImbalanceIndex::merge(const Node& _left, const Node& _right) {
+    return Node{std::min(_left.min, _right.min), std::max(_left.max, _right.max),
+                std::max(_left.worn, _right.worn)};
+}
+
+void ImbalanceIndex::set(unsigned int _site, long _stock) {
+    leaves[_site].stock.store(_stock, std::memory_order_relaxed);
+    markDirty(_site);
+}
+
+void ImbalanceIndex::add(unsigned int _site, long _delta) {
+    leaves[_site].stock.fetch_add(_delta, std::memory_order_relaxed);
+    markDirty(_site);
+}
+
+void ImbalanceIndex::setWorn(unsigned int _site, long _nbWorn) {
+    leaves[_site].worn.store(_nbWorn, std::memory_order_relaxed);
+    markDirty(_site);
+}
+
+void ImbalanceIndex::addWorn(unsigned int _site, long _delta) {
+    leaves[_site].worn.fetch_add(_delta, std::memory_order_relaxed);
+    markDirty(_site);
+}
+
+void ImbalanceIndex::markDirty(unsigned int _site) {
+    std::atomic<std::uint64_t>& word = dirty[_site / 64];
+    const std::uint64_t bit = std::uint64_t(1) << (_site % 64);
+
+    // Toujours un fetch_or : le bit et l'échange de refreshLocked() sont ordonnés sur le même mot,
+    // le bit levé après l'échange reste donc pour la requête suivante. Sauter l'écriture quand le
+    // bit paraît levé pourrait lire une valeur antérieure à l'échange et perdre la mise à jour.
+    // release : la requête qui consomme le bit voit le stock écrit avant
+    word.fetch_or(bit, std::memory_order_release);
+}
+
+long ImbalanceIndex::imbalance(unsigned int _site) const {
+    return leaves[_site].stock.load(std::memory_order_relaxed) - goal;
+}
+
+void ImbalanceIndex::refreshLocked() {
+    for (size_t w = 0; w < nbDirtyWords; ++w) {
+        // Un site modifié après l'échange relève son bit : il sera repris à la requête suivante
+        std::uint64_t bits = dirty[w].exchange(0, std::memory_order_acquire);
+        while (bits) {
+            size_t site = w * 64 + std::countr_zero(bits);
+            bits &= bits - 1;
+
+            long value = leaves[site].stock.load(std::memory_order_relaxed) - goal;
+            long worn = leaves[site].worn.load(std::memory_order_relaxed);
+            size_t i = size + site;
+            tree[i] = Node{value, value, worn};
+
+            // Remonter tant que le noeud change
+            for (i >>= 1; i > 0; i >>= 1) {
+                Node updated = merge(tree[2 * i], tree[2 * i + 1]);
+                if (updated.min == tree[i].min && updated.max == tree[i].max && updated.worn == tree[i].worn)
+                    break;
+                tree[i] = updated;
+            }
+        }
+    }
+}
+
+std::vector<ImbalanceIndex::Entry> ImbalanceIndex::top(size_t _k, Order _order) {
+    std::vector<Entry> result;
+
+    mutex.lock();
+    refreshLocked();
+
+    // Clé d'un noeud : le pire site de son intervalle, orienté pour que plus grand soit pire
+    auto key = [&](size_t _node) {
+        switch (_order) {
+        case Order::Starved:
+            return -tree[_node].min;
+        case Order::Saturated:
+            return tree[_node].max;
+        default:
+            return tree[_node].worn;
+        }
+    };
+    auto lower = [&](size_t _a, size_t _b) { return key(_a) < key(_b); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(lower)> frontier(lower);
+
+    if (count > 0)
+        frontier.push(1);
+
+    // Les noeuds sortent par clé décroissante : on s'arrête au premier site équilibré
+    while (result.size() < _k && !frontier.empty()) {
+        size_t node = frontier.top();
+        frontier.pop();
+
+        if (key(node) <= 0)
+            break;
+
+        if (node >= size) {
+            result.push_back(Entry{static_cast<unsigned int>(node - size), tree[node].min});
+            continue;
+        }
+        frontier.push(2 * node);
+        frontier.push(2 * node + 1);
+    }
+
+    mutex.unlock();
+    return result;
+}
+
+std::vector<ImbalanceIndex::Entry> ImbalanceIndex::mostStarved(size_t _k) {
+    return top(_k, Order::Starved);
+}
+
+std::vector<ImbalanceIndex::Entry> ImbalanceIndex::mostSaturated(size_t _k) {
+    return top(_k, Order::Saturated);
+}
+
+std::vector<ImbalanceIndex::Entry> ImbalanceIndex::mostWorn(size_t _k) {
+    return top(_k, Order::Worn);
+}
@@ -0,0 +1,192 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : latencyhistogram.cpp
+ * Histogrammes d'attente des personnes (classes log-linéaires) et enregistreur à tampons par thread.
+ */
+
+#include "latencyhistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Nombre de bits significatifs de _value (0 pour 0)
+unsigned int bitWidth(std::uint64_t _value) {
+    unsigned int width = 0;
+    while (_value) {
+        ++width;
+        _value >>= 1;
+    }
+    return width;
+}
+
+const char* const KIND_NAMES[LatencyRecorder::nbKinds] = {"rent", "dock"};
+
+} // namespace
+
+unsigned int LatencyHistogram::bucketOf(std::uint64_t _ms) {
+    if (_ms < 2 * subBuckets)
+        return static_cast<unsigned int>(_ms);
+
+    // Décalage ramenant la valeur dans [subBuckets, 2 * subBuckets)
+    unsigned int shift = bitWidth(_ms) - (subBucketBits + 1);
+    return 2 * subBuckets + (shift - 1) * subBuckets
+            + static_cast<unsigned int>((_ms >> shift) - subBuckets);
+}
+
+std::uint64_t LatencyHistogram::lowerBound(unsigned int _bucket) {
+    if (_bucket < 2 * subBuckets)
+        return _bucket;
+
+    unsigned int shift = (_bucket - 2 * subBuckets) / subBuckets + 1;
+    std::uint64_t mantissa = (_bucket - 2 * subBuckets) % subBuckets + subBuckets;
+    return mantissa << shift;
+}
+
+std::uint64_t LatencyHistogram::upperBound(unsigned int _bucket) {
+    if (_bucket < 2 * subBuckets)
+        return _bucket;
+
+    unsigned int shift = (_bucket - 2 * subBuckets) / subBuckets + 1;
+    return lowerBound(_bucket) + (std::uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t _ms) {
+    _ms = std::min(_ms, maxValue);
+    ++counts[bucketOf(_ms)];
+    ++total;
+    sum += _ms;
+    maxRecorded = std::max(maxRecorded, _ms);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& _other) {
+    for (unsigned int b = 0; b < nbBuckets; ++b)
+        counts[b] += _other.counts[b];
+    total += _other.total;
+    sum += _other.sum;
+    maxRecorded = std::max(maxRecorded, _other.maxRecorded);
+}
+
+std::uint64_t LatencyHistogram::percentile(double _percentile) const {
+    if (total == 0)
+        return 0;
+
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(_percentile / 100.0 * total));
+    rank = std::max<std::uint64_t>(rank, 1);
+
+    std::uint64_t seen = 0;
+    for (unsigned int b = 0; b < nbBuckets; ++b) {
+        seen += counts[b];
+        if (seen >= rank)
+            return std::min(upperBound(b), maxRecorded);
+    }
+    return maxRecorded;
+}
+
+LatencyRecorder& LatencyRecorder::instance() {
+    static LatencyRecorder recorder;
+    return recorder;
+}
+
+LatencyRecorder::Buffer* LatencyRecorder::localBuffer() {
+    thread_local Buffer* buffer = nullptr;
+    if (!buffer) {
+        auto created = std::make_unique<Buffer>();
+        buffer = created.get();
+        mutex.lock();
+        buffers.push_back(std::move(created));
+        mutex.unlock();
+    }
+    return buffer;
+}
+
+void LatencyRecorder::record(Kind _kind, unsigned int _site, size_t _type, std::uint64_t _ms) {
+    Buffer* buffer = localBuffer();
+    unsigned int slot = (_kind * NB_SITES_TOTAL + _site) * Bike::nbBikeTypes + _type;
+
+    buffer->mutex.lock();
+    auto& histogram = buffer->histograms[slot];
+    if (!histogram)
+        histogram = std::make_unique<LatencyHistogram>();
+    histogram->record(_ms);
+    buffer->mutex.unlock();
+}
+
+std::unique_ptr<LatencyRecorder::Table> LatencyRecorder::merge() const {
+    auto table = std::make_unique<Table>();
+
+    mutex.lock();
+    for (const auto& buffer : buffers) {
+        buffer->mutex.lock();
+        for (unsigned int slot = 0; slot < nbSlots; ++slot) {
+            if (!buffer->histograms[slot])
+                continue;
+            unsigned int type = slot % Bike::nbBikeTypes;
+            unsigned int site = (slot / Bike::nbBikeTypes) % NB_SITES_TOTAL;
+            unsigned int kind = slot / (Bike::nbBikeTypes * NB_SITES_TOTAL);
+            (*table)[kind][site][type].merge(*buffer->histograms[slot]);
+        }
+        buffer->mutex.unlock();
+    }
+    mutex.unlock();
+
+    return table;
+}
+
+std::string LatencyRecorder::report(const Table& _table) {
+    std::ostringstream out;
+    char line[160];
+
+    for (unsigned int kind = 0; kind < nbKinds; ++kind) {
+        std::snprintf(line, sizeof(line), "%-5s %-6s %-5s %8s %8s %8s %8s %8s\n",
+                      KIND_NAMES[kind], "site", "type", "count", "p50", "p90", "p99", "max");
+        out << line;
+
+        for (unsigned int site = 0; site < NB_SITES_TOTAL; ++site) {
+            for (unsigned int type = 0; type < Bike::nbBikeTypes; ++type) {
+                const LatencyHistogram& h = _table[kind][site][type];
+                if (h.count() == 0)
+                    continue;
+                std::snprintf(line, sizeof(line), "%-5s %-6u %-5u %8llu %8llu %8llu %8llu %8llu\n",
+                              "", site, type,
+                              static_cast<unsigned long long>(h.count()),
+                              static_cast<unsigned long long>(h.percentile(50)),
+                              static_cast<unsigned long long>(h.percentile(90)),
+                              static_cast<unsigned long long>(h.percentile(99)),
+                              static_cast<unsigned long long>(h.max()));
+                out << line;
+            }
+        }
+        out << "\n";
+    }
+
+    return out.str();
+}
+
+bool LatencyRecorder::dump(const std::string& _path, const Table& _table) {
+    std::ofstream out(_path);
+    if (!out)
+        return false;
+
+    out << "kind,site,type,lower_ms,upper_ms,count\n";
+    for (unsigned int kind = 0; kind < nbKinds; ++kind)
+        for (unsigned int site = 0; site < NB_SITES_TOTAL; ++site)
+            for (unsigned int type = 0; type < Bike::nbBikeTypes; ++type) {
+                const LatencyHistogram& h = _table[kind][site][type];
+                for (unsigned int b = 0; b < LatencyHistogram::nbBuckets; ++b)
+                    if (h.bucketCount(b))
+                        out << KIND_NAMES[kind] << ',' << site << ',' << type << ','
+                            << LatencyHistogram::lowerBound(b) << ','
+                            << LatencyHistogram::upperBound(b) << ','
+                            << h.bucketCount(b) << '\n';
+            }
+
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,160 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : lockprofiler.cpp
+ * Instrumentation des verrous des stations (compilée uniquement avec LOCK_PROFILING) et
+ * rapporteur périodique des stations les plus disputées.
+ */
+
+#include "lockprofiler.h"
+
+#ifdef LOCK_PROFILING
+
+#include <algorithm>
+#include <cstdio>
+
+#include "config.h"
+#include "timerwheel.h"
+
+namespace {
+
+std::uint64_t elapsedNs(std::chrono::steady_clock::time_point _from,
+                        std::chrono::steady_clock::time_point _to) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(_to - _from).count();
+}
+
+} // namespace
+
+StationLock::StationLock() {
+    LockProfiler::instance().add(this);
+}
+
+StationLock::~StationLock() {
+    LockProfiler::instance().remove(this);
+}
+
+void StationLock::lock() {
+    if (!mutex.trylock()) {
+        // Verrou pris : on mesure l'attente et la file
+        unsigned int depth = counters.queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+        unsigned int max = counters.maxQueueDepth.load(std::memory_order_relaxed);
+        while (depth > max && !counters.maxQueueDepth.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+        }
+
+        Clock::time_point start = Clock::now();
+        mutex.lock();
+        acquiredAt = Clock::now();
+
+        counters.queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        counters.contended.fetch_add(1, std::memory_order_relaxed);
+        counters.waitNs.fetch_add(elapsedNs(start, acquiredAt), std::memory_order_relaxed);
+    }
+    else {
+        acquiredAt = Clock::now();
+    }
+
+    counters.acquisitions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StationLock::unlock() {
+    counters.holdNs.fetch_add(elapsedNs(acquiredAt, Clock::now()), std::memory_order_relaxed);
+    mutex.unlock();
+}
+
+void StationLock::wait(PcoConditionVariable& _condition) {
+    // Le temps bloqué sur la condition n'est pas du temps de détention
+    counters.holdNs.fetch_add(elapsedNs(acquiredAt, Clock::now()), std::memory_order_relaxed);
+    counters.conditionWaiters.fetch_add(1, std::memory_order_relaxed);
+
+    _condition.wait(&mutex);
+
+    counters.conditionWaiters.fetch_sub(1, std::memory_order_relaxed);
+    counters.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    acquiredAt = Clock::now();
+}
+
+LockProfiler& LockProfiler::instance() {
+    static LockProfiler profiler;
+    return profiler;
+}
+
+void LockProfiler::add(const StationLock* _lock) {
+    mutex.lock();
+    entries.push_back({_lock, nextIndex++, {}});
+    mutex.unlock();
+}
+
+void LockProfiler::remove(const StationLock* _lock) {
+    mutex.lock();
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [_lock](const Entry& _entry) { return _entry.lock == _lock; }),
+                  entries.end());
+    mutex.unlock();
+}
+
+void LockProfiler::runReporter() {
+    struct Row
+    {
+        unsigned int index;
+        Sample delta;
+        unsigned int depth;
+        unsigned int maxDepth;
+        unsigned int conditionWaiters;
+    };
+    std::vector<Row> rows;
+
+    // La roue arrêtée, sleepFor() revient immédiatement : dernier rapport puis fin
+    bool running = true;
+    while (running) {
+        unsigned long long before = TimerWheel::instance().nowMs();
+        TimerWheel::instance().sleepFor(LOCK_REPORT_PERIOD_MS);
+        running = TimerWheel::instance().nowMs() - before >= LOCK_REPORT_PERIOD_MS;
+
+        rows.clear();
+        mutex.lock();
+        for (Entry& entry : entries) {
+            const LockStats& stats = entry.lock->stats();
+            Sample now;
+            now.acquisitions = stats.acquisitions.load(std::memory_order_relaxed);
+            now.contended = stats.contended.load(std::memory_order_relaxed);
+            now.waitNs = stats.waitNs.load(std::memory_order_relaxed);
+            now.holdNs = stats.holdNs.load(std::memory_order_relaxed);
+
+            Sample delta;
+            delta.acquisitions = now.acquisitions - entry.last.acquisitions;
+            delta.contended = now.contended - entry.last.contended;
+            delta.waitNs = now.waitNs - entry.last.waitNs;
+            delta.holdNs = now.holdNs - entry.last.holdNs;
+            entry.last = now;
+
+            rows.push_back({entry.index, delta,
+                            stats.queueDepth.load(std::memory_order_relaxed),
+                            stats.maxQueueDepth.load(std::memory_order_relaxed),
+                            stats.conditionWaiters.load(std::memory_order_relaxed)});
+        }
+        mutex.unlock();
+
+        // Les plus disputés d'abord : temps total passé à attendre le verrou
+        size_t top = std::min<size_t>(LOCK_REPORT_TOP, rows.size());
+        std::partial_sort(rows.begin(), rows.begin() + top, rows.end(),
+                          [](const Row& _a, const Row& _b) { return _a.delta.waitNs > _b.delta.waitNs; });
+
+        std::fprintf(stderr, "[lock profile] top %zu of %zu station locks over the last period\n",
+                     top, rows.size());
+        std::fprintf(stderr, "  %-8s %10s %10s %12s %12s %6s %6s %6s\n",
+                     "station", "acquired", "contended", "wait(us)", "hold(us)", "queue", "max", "cond");
+        for (size_t i = 0; i < top; ++i) {
+            const Row& row = rows[i];
+            std::fprintf(stderr, "  %-8u %10llu %9.1f%% %12.1f %12.1f %6u %6u %6u\n",
+                         row.index,
+                         static_cast<unsigned long long>(row.delta.acquisitions),
+                         row.delta.acquisitions ? 100.0 * row.delta.contended / row.delta.acquisitions : 0.0,
+                         row.delta.waitNs / 1e3, row.delta.holdNs / 1e3,
+                         row.depth, row.maxDepth, row.conditionWaiters);
+        }
+    }
+}
+
+#endif // LOCK_PROFILING
@@ -0,0 +1,198 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : logpanel.cpp
+ * Panneau du journal : modèle filtré sur le LogStore, publication groupée des ajouts et widget de
+ * filtre et de recherche.
+ */
+
+#include "logpanel.h"
+#include "config.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QScrollBar>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Délai de la recherche après la dernière frappe (ms réelles)
+const int SEARCH_DELAY_MS = 250;
+
+} // namespace
+
+LogPanelModel::LogPanelModel(size_t _maxRows, const QString& _spillPath, QObject* _parent)
+    : QAbstractTableModel(_parent),
+      m_store(_maxRows, _spillPath)
+{
+    // Publication au prochain tour de la boucle d'événements, une fois par lot d'ajouts
+    m_publishTimer.setSingleShot(true);
+    m_publishTimer.setInterval(0);
+    connect(&m_publishTimer, &QTimer::timeout, this, &LogPanelModel::publish);
+}
+
+int LogPanelModel::rowCount(const QModelIndex& _parent) const {
+    return _parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int LogPanelModel::columnCount(const QModelIndex& _parent) const {
+    return _parent.isValid() ? 0 : NbColumns;
+}
+
+QVariant LogPanelModel::data(const QModelIndex& _index, int _role) const {
+    if (_role != Qt::DisplayRole || !_index.isValid() || static_cast<size_t>(_index.row()) >= m_rows.size())
+        return QVariant();
+
+    // Entrée retirée du journal, pas encore publiée comme telle
+    std::uint64_t seq = m_rows[_index.row()];
+    if (seq < m_store.begin())
+        return QVariant();
+
+    switch (_index.column()) {
+    case TimeColumn:
+        return LogStore::time(m_store.timeMs(seq));
+    case SourceColumn:
+        return LogStore::source(m_store.entity(seq));
+    case MessageColumn:
+        return m_store.message(seq);
+    }
+    return QVariant();
+}
+
+QVariant LogPanelModel::headerData(int _section, Qt::Orientation _orientation, int _role) const {
+    if (_role != Qt::DisplayRole || _orientation != Qt::Horizontal)
+        return QVariant();
+
+    switch (_section) {
+    case TimeColumn:
+        return QString("Temps (s)");
+    case SourceColumn:
+        return QString("Source");
+    case MessageColumn:
+        return QString("Message");
+    }
+    return QVariant();
+}
+
+void LogPanelModel::append(const LogRecord& _record, const QString& _text) {
+    m_store.append(_record, _text);
+    if (!m_publishTimer.isActive())
+        m_publishTimer.start();
+}
+
+bool LogPanelModel::matches(std::uint64_t _seq) const {
+    if (m_entity >= 0 && m_store.entity(_seq) != static_cast<std::uint32_t>(m_entity))
+        return false;
+    // Seule la recherche oblige à mettre le message en forme
+    return m_search.isEmpty() || m_store.message(_seq).contains(m_search, Qt::CaseInsensitive);
+}
+
+void LogPanelModel::publish() {
+    // Entrées retirées du journal : toujours en tête de la liste
+    size_t evicted = 0;
+    while (evicted < m_rows.size() && m_rows[evicted] < m_store.begin())
+        ++evicted;
+    if (evicted > 0) {
+        beginRemoveRows(QModelIndex(), 0, static_cast<int>(evicted) - 1);
+        m_rows.erase(m_rows.begin(), m_rows.begin() + evicted);
+        endRemoveRows();
+    }
+
+    // Nouvelles entrées retenues par le filtre, en une insertion
+    std::vector<std::uint64_t> added;
+    for (std::uint64_t seq = std::max(m_published, m_store.begin()); seq < m_store.end(); ++seq) {
+        if (matches(seq))
+            added.push_back(seq);
+    }
+    m_published = m_store.end();
+
+    if (!added.empty()) {
+        int first = static_cast<int>(m_rows.size());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(added.size()) - 1);
+        m_rows.insert(m_rows.end(), added.begin(), added.end());
+        endInsertRows();
+    }
+}
+
+void LogPanelModel::setFilter(long _entity, const QString& _search) {
+    beginResetModel();
+    m_entity = _entity;
+    m_search = _search;
+    m_rows.clear();
+    for (std::uint64_t seq = m_store.begin(); seq < m_store.end(); ++seq) {
+        if (matches(seq))
+            m_rows.push_back(seq);
+    }
+    m_published = m_store.end();
+    endResetModel();
+}
+
+LogPanel::LogPanel(unsigned int _maxEntity, QWidget* _parent)
+    : QWidget(_parent)
+{
+    m_model = new LogPanelModel(LOG_MAX_ROWS, QString(LOG_SPILL_FILE), this);
+
+    m_source = new QSpinBox(this);
+    m_source->setRange(-1, static_cast<int>(_maxEntity));
+    m_source->setValue(-1);
+    m_source->setSpecialValueText("Toutes");
+    m_source->setToolTip("0 : système et van, n : personne n");
+
+    m_search = new QLineEdit(this);
+    m_search->setPlaceholderText("Rechercher...");
+    m_search->setClearButtonEnabled(true);
+
+    // Lignes de hauteur fixe : la vue ne met en page que les lignes visibles
+    m_view = new QTableView(this);
+    m_view->setModel(m_model);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setWordWrap(false);
+    m_view->verticalHeader()->hide();
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(m_view->fontMetrics().height() + 4);
+    m_view->horizontalHeader()->setStretchLastSection(true);
+    m_view->setMinimumWidth(200);
+
+    auto* filters = new QHBoxLayout;
+    filters->addWidget(new QLabel("Source", this));
+    filters->addWidget(m_source);
+    filters->addWidget(m_search, 1);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(filters);
+    layout->addWidget(m_view);
+
+    m_searchDelay.setSingleShot(true);
+    m_searchDelay.setInterval(SEARCH_DELAY_MS);
+    connect(&m_searchDelay, &QTimer::timeout, this, &LogPanel::applyFilter);
+    connect(m_search, &QLineEdit::textChanged, this, [this] { m_searchDelay.start(); });
+    connect(m_source, QOverload<int>::of(&QSpinBox::valueChanged), this, &LogPanel::applyFilter);
+
+    // On ne suit la fin du journal que si la vue y était déjà
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeInserted, this, [this] {
+        QScrollBar* bar = m_view->verticalScrollBar();
+        m_follow = bar->value() == bar->maximum();
+    });
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, [this] {
+        if (m_follow)
+            m_view->scrollToBottom();
+    });
+}
+
+void LogPanel::append(const LogRecord& _record, const QString& _text) {
+    m_model->append(_record, _text);
+}
+
+void LogPanel::applyFilter() {
+    m_searchDelay.stop();
+    m_model->setFilter(m_source->value(), m_search->text());
+    m_view->scrollToBottom();
+}
@@ -0,0 +1,99 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : logstore.cpp
+ * Stockage en colonnes du journal : ajout dans l'anneau, retrait par paquets vers le fichier de
+ * débordement et mise en forme des messages à la demande.
+ */
+
+#include "logstore.h"
+
+#include <algorithm>
+
+LogStore::LogStore(size_t _maxRows, const QString& _spillPath)
+    : m_capacity(std::max<size_t>(_maxRows, 1)),
+      m_entity(m_capacity),
+      m_timeMs(m_capacity),
+      m_message(m_capacity),
+      m_args(m_capacity * LOG_NB_ARGS),
+      m_spill(_spillPath)
+{}
+
+std::uint64_t LogStore::append(const LogRecord& _record, const QString& _text) {
+    // Anneau plein : on libère un huitième d'un coup, les vues n'ont qu'un retrait à suivre
+    if (m_end - m_begin == m_capacity)
+        evict(std::max<size_t>(m_capacity / 8, 1));
+
+    const size_t s = slot(m_end);
+    m_entity[s] = _record.entity;
+    m_timeMs[s] = _record.timeMs;
+    m_message[s] = _record.message;
+    std::copy_n(_record.args, LOG_NB_ARGS, &m_args[s * LOG_NB_ARGS]);
+
+    if (_record.message == LogMessage::Text) {
+        m_args[s * LOG_NB_ARGS] = static_cast<std::int64_t>(m_firstText + m_texts.size());
+        m_texts.push_back(_text);
+    }
+
+    return m_end++;
+}
+
+void LogStore::evict(size_t _count) {
+    if (!m_spill.fileName().isEmpty() && !m_spill.isOpen())
+        m_spill.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+
+    for (size_t i = 0; i < _count && m_begin < m_end; ++i, ++m_begin) {
+        if (m_spill.isOpen()) {
+            QString line = QString("%1 %2 : %3\n").arg(time(timeMs(m_begin)), source(entity(m_begin)),
+                                                       message(m_begin));
+            m_spill.write(line.toUtf8());
+        }
+
+        // Les textes libres sont retirés dans l'ordre où ils ont été ajoutés
+        if (m_message[slot(m_begin)] == LogMessage::Text) {
+            m_texts.pop_front();
+            ++m_firstText;
+        }
+    }
+
+    if (m_spill.isOpen())
+        m_spill.flush();
+}
+
+QString LogStore::message(std::uint64_t _seq) const {
+    const size_t s = slot(_seq);
+    const std::int64_t* args = &m_args[s * LOG_NB_ARGS];
+    if (m_message[s] == LogMessage::Text)
+        return m_texts[static_cast<size_t>(args[0] - static_cast<std::int64_t>(m_firstText))];
+    return format(m_message[s], args, QString());
+}
+
+QString LogStore::format(LogMessage _message, const std::int64_t* _args, const QString& _text) {
+    switch (_message) {
+    case LogMessage::Text:
+        return _text;
+    case LogMessage::PersonPrefers:
+        return QString("Person %1, préfère type %2").arg(_args[0]).arg(_args[1]);
+    case LogMessage::SiteOverloaded:
+        return QString("Person %1, site %2 surchargé, redirigée vers %3").arg(_args[0]).arg(_args[1]).arg(_args[2]);
+    case LogMessage::VanStopped:
+        return QString("Van s'arrête proprement");
+    case LogMessage::VanServiced:
+        return QString("Van : %1 vélo(s) révisé(s) au dépôt").arg(_args[0]);
+    case LogMessage::AgentsStopped:
+        return QString("Tous les agents arrêtés en %1 ms").arg(_args[0] / 1e3, 0, 'f', 3);
+    case LogMessage::EventsDropped:
+        return QString("%1 événement(s) d'affichage perdu(s)").arg(_args[0]);
+    }
+    return QString();
+}
+
+QString LogStore::source(std::uint32_t _entity) {
+    return _entity == 0 ? QString("Système") : QString("Person %1").arg(_entity);
+}
+
+QString LogStore::time(std::uint64_t _timeMs) {
+    return QString::number(_timeMs / 1e3, 'f', 3);
+}
@@ -11,31 +11,84 @@
 #include <QApplication>
 #include "bikinginterface.h"
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <vector>
 
 #include "person.h"
 #include "van.h"
 #include "bikestation.h"
 #include "config.h"
+#include "sitemap.h"
+#include "demandmodel.h"
+#include "timerwheel.h"
+#include "checkpoint.h"
+#include "lockprofiler.h"
+#include "shutdown.h"
 
 #include <pcosynchro/pcothread.h>
 
 std::array<BikeStation*, NB_SITES_TOTAL>* globalStations = nullptr;
 std::vector<std::unique_ptr<PcoThread>>* globalThreads = nullptr;
+const SiteMap* globalSiteMap = nullptr;
+
+// Tous les vélos de la simulation (modifié uniquement par le thread principal / GUI, lu par la
+// sauvegarde, pendant laquelle l'interface ne le modifie pas)
+std::vector<Bike*> globalFleet;
+unsigned int nextBikeId = 0;
+
+// Creates a bike and adds it to the fleet
+Bike* createBike(unsigned int _type) {
+    auto* bike = new Bike;
+    bike->id = nextBikeId++;
+    bike->bikeType = _type;
+    globalFleet.push_back(bike);
+    return bike;
+}
+
+// Removes a bike from the fleet and deletes it
+void destroyBike(Bike* _bike) {
+    globalFleet.erase(std::remove(globalFleet.begin(), globalFleet.end(), _bike), globalFleet.end());
+    delete _bike;
+}
+
+// Writes a checkpoint of the running simulation; blocks while the agents reach a quiescent point
+bool checkpointSimulation() {
+    if (!globalStations)
+        return false;
+    return Checkpoint::instance().save(CHECKPOINT_FILE, *globalStations, globalFleet);
+}
+
+// Agents still running, and date at which the stop was requested (0 if not yet)
+std::atomic<unsigned int> runningAgents{0};
+std::atomic<long long> stopRequestedNs{0};
+BikingInterface* globalInterface = nullptr;
+
+static long long steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Called by each agent thread when its run() returns; the last one reports the shutdown latency
+void agentFinished() {
+    if (runningAgents.fetch_sub(1) != 1)
+        return;
+
+    long long requested = stopRequestedNs.load();
+    if (requested != 0 && globalInterface) {
+        globalInterface->log(0, LogMessage::AgentsStopped, (steadyNowNs() - requested) / 1000);
+    }
+}
 
 // Should stop all threads and release waiting ones
 void stopSimulation() {
-    // Signaler l'arrêt à toutes les BikeStations pour réveiller tous les threads bloqués
-    if (globalStations)
-        for (size_t i = 0; i < NB_SITES_TOTAL; ++i)
-            if ((*globalStations)[i])
-                (*globalStations)[i]->ending();
-
-    // Demander l'arrêt à tous les threads
-    if (globalThreads)
-        for (auto& thread : *globalThreads)
-            if (thread)
-                thread->requestStop();
+    long long expected = 0;
+    stopRequestedNs.compare_exchange_strong(expected, steadyNowNs());
+
+    if (globalThreads && globalStations)
+        requestShutdown(*globalThreads, *globalStations);
 }
 
 
@@ -57,46 +110,38 @@ int main(int argc, char* argv[]) {
     std::vector<std::unique_ptr<PcoThread>> threads;
     std::array<BikeStation*, NB_SITES_TOTAL> bikeStations;
 
+    // Reprise d'une sauvegarde : --restore <fichier>
+    SimulationState saved;
+    bool restoring = false;
+    if (argc >= 3 && std::strcmp(argv[1], "--restore") == 0) {
+        restoring = Checkpoint::load(argv[2], saved);
+        if (!restoring)
+            throw std::runtime_error("Invalid checkpoint file");
+    }
+
+    // Spatial layout of the sites (circle if no file is provided)
+    SiteMap siteMap;
+    siteMap.loadFromFile(SITES_FILE);
+    globalSiteMap = &siteMap;
+
     // Init of GUI
     BikingInterface::initialize(NBPEOPLE, NBSITES);
     auto* binkingInterface = new BikingInterface();
 
-    // Create bikes stations with BORNES slots
+    // Create bikes stations with BORNES slots and bounded waiting queues
+    const AdmissionLimits siteAdmission{MAX_WAITING_RIDERS, MAX_WAITING_DEPOSITORS};
     for (size_t s = 0; s < NBSITES; ++s) {
-        bikeStations[s] = new BikeStation(BORNES);
+        bikeStations[s] = new BikeStation(BORNES, SITE_WAIT_POLICY, siteAdmission);
     }
 
-    // Create depot with NB_BIKES slots
-    bikeStations[DEPOT_ID] = new BikeStation(NB_BIKES);
-
-    // Create all bikes
-    std::vector<Bike*> allBikes;
-    allBikes.reserve(NB_BIKES);
-    for (size_t i = 0; i < NB_BIKES; ++i) {
-        auto* bike = new Bike;
-        bike->bikeType = i % Bike::nbBikeTypes;
-        allBikes.push_back(bike);
-    }
-
-    // Distribute bikes to stations
-    size_t idx = 0;
+    // Global imbalance index of the sites, fed by every station update
+    ImbalanceIndex imbalanceIndex(NBSITES, BORNES - 2);
     for (size_t s = 0; s < NBSITES; ++s) {
-        std::vector<Bike*> chunk;
-        for (size_t k = 0; k < BORNES - 2; ++k) {
-            chunk.push_back(allBikes[idx++]);
-        }
-
-        bikeStations[s]->addBikes(chunk);
-        binkingInterface->setInitBikes(s, chunk.size());
+        bikeStations[s]->trackImbalance(&imbalanceIndex, s);
     }
 
-    // Remaining bikes go to depot
-    std::vector<Bike*> depotBikes;
-    for (; idx < allBikes.size(); ++idx) {
-        depotBikes.push_back(allBikes[idx]);
-    }
-    bikeStations[DEPOT_ID]->addBikes(depotBikes);
-    binkingInterface->setInitBikes(DEPOT_ID, depotBikes.size());
+    // Create depot with NB_BIKES slots (more if bikes were added before the checkpoint)
+    bikeStations[DEPOT_ID] = new BikeStation(std::max<size_t>(NB_BIKES, saved.bikes.size()), DEPOT_WAIT_POLICY);
 
     // Setting up pointer for interfaces
     Person::setInterface(binkingInterface);
@@ -106,18 +151,116 @@ int main(int argc, char* argv[]) {
     Person::setStations(bikeStations);
     Van::setStations(bikeStations);
 
+    // Setting up the spatial model
+    Person::setSiteMap(&siteMap);
+    Van::setSiteMap(&siteMap);
+    Van::setImbalanceIndex(&imbalanceIndex);
+
+    // Origin-destination demand, only if a demand file is provided
+    DemandModel demandModel;
+    if (demandModel.loadFromFile(DEMAND_FILE))
+        Person::setDemandModel(&demandModel);
+
+    std::vector<Person*> people;
+    Van* van = new Van(0);
+
+    if (restoring) {
+        // Recreate the saved bikes, with their wear
+        std::vector<Bike*> byId;
+        for (const BikeRecord& record : saved.bikes) {
+            Bike* bike = createBike(record.bikeType);
+            bike->id = record.id;
+            bike->nbRides = record.nbRides;
+            bike->totalRideTimeMs = record.totalRideTimeMs;
+            bike->ridesSinceService = record.ridesSinceService;
+            bike->needsMaintenance = record.needsMaintenance;
+            nextBikeId = std::max(nextBikeId, record.id + 1);
+            if (byId.size() <= record.id)
+                byId.resize(record.id + 1, nullptr);
+            byId[record.id] = bike;
+        }
+
+        // Refill the stations
+        for (size_t s = 0; s < NB_SITES_TOTAL; ++s) {
+            std::vector<Bike*> chunk;
+            for (unsigned int bikeId : saved.stations[s])
+                chunk.push_back(byId[bikeId]);
+
+            bikeStations[s]->addBikes(chunk);
+            binkingInterface->setInitBikes(s, chunk.size());
+        }
+
+        // Agents resume where they were, with the bikes they held
+        for (const AgentState& agent : saved.agents) {
+            std::vector<Bike*> held;
+            for (unsigned int bikeId : agent.bikes)
+                held.push_back(byId[bikeId]);
+
+            if (agent.kind == AgentState::VanAgent) {
+                if (!van->restore(agent, std::move(held)))
+                    throw std::runtime_error("Invalid checkpoint file");
+                continue;
+            }
+
+            auto* person = new Person(agent.id);
+            person->restore(agent, held.empty() ? nullptr : held.front());
+            people.push_back(person);
+            binkingInterface->setInitPerson(agent.site, agent.id);
+        }
+
+        TimerWheel::instance().setStartTime(saved.simTimeMs);
+    }
+    else {
+        // Create all bikes
+        std::vector<Bike*> allBikes;
+        allBikes.reserve(NB_BIKES);
+        for (size_t i = 0; i < NB_BIKES; ++i) {
+            allBikes.push_back(createBike(i % Bike::nbBikeTypes));
+        }
+
+        // Distribute bikes to stations
+        size_t idx = 0;
+        for (size_t s = 0; s < NBSITES; ++s) {
+            std::vector<Bike*> chunk;
+            for (size_t k = 0; k < BORNES - 2; ++k) {
+                chunk.push_back(allBikes[idx++]);
+            }
+
+            bikeStations[s]->addBikes(chunk);
+            binkingInterface->setInitBikes(s, chunk.size());
+        }
+
+        // Remaining bikes go to depot
+        std::vector<Bike*> depotBikes;
+        for (; idx < allBikes.size(); ++idx) {
+            depotBikes.push_back(allBikes[idx]);
+        }
+        bikeStations[DEPOT_ID]->addBikes(depotBikes);
+        binkingInterface->setInitBikes(DEPOT_ID, depotBikes.size());
+
+        for (size_t i = 1; i <= NBPEOPLE; ++i) {
+            people.push_back(new Person(i));
+            binkingInterface->setInitPerson(0, i);
+        }
+    }
+
     globalStations = &bikeStations;
     globalThreads = &threads;
 
-    // Starting people and van threads
-    for(size_t i = 0; i <= NBPEOPLE; ++i){
-        if(i == 0) {
-            threads.emplace_back(std::make_unique<PcoThread>(&Van::run, new Van(i)));
-            continue;
-        }
+    // Starting the timer wheel driving the simulated clock
+    threads.emplace_back(std::make_unique<PcoThread>(&TimerWheel::run, &TimerWheel::instance()));
+
+#ifdef LOCK_PROFILING
+    // Rapport périodique des stations les plus disputées
+    threads.emplace_back(std::make_unique<PcoThread>(&LockProfiler::runReporter, &LockProfiler::instance()));
+#endif
 
-        threads.emplace_back(std::make_unique<PcoThread>(&Person::run, new Person(i)));
-        binkingInterface->setInitPerson(0, i);
+    // Starting people and van threads
+    globalInterface = binkingInterface;
+    runningAgents = people.size() + 1;
+    threads.emplace_back(std::make_unique<PcoThread>([van] { van->run(); agentFinished(); }));
+    for (Person* person : people) {
+        threads.emplace_back(std::make_unique<PcoThread>([person] { person->run(); agentFinished(); }));
     }
 
     int ret = a.exec();
@@ -9,41 +9,45 @@
 #include <QToolBar>
 #include <QAction>
 #include <QCoreApplication>
+#include <QDialog>
+#include <QFontDatabase>
+#include <QPlainTextEdit>
+#include <QVBoxLayout>
 #include "mainwindow.h"
+#include "sitemap.h"
+#include "latencyhistogram.h"
+#include "timerwheel.h"
 
 #define min(a,b) ((a<b)?(a):(b))
 
 extern std::array<BikeStation*, NB_SITES_TOTAL>* globalStations;
+extern const SiteMap* globalSiteMap;
 
 extern void stopSimulation();
+extern bool checkpointSimulation();
+extern Bike* createBike(unsigned int _type);
+extern void destroyBike(Bike* _bike);
 
 MainWindow::MainWindow(unsigned int nbConsoles,unsigned int nbSite,
                        QWidget *parent)
     : QMainWindow(parent)
 {
     m_nbConsoles=nbConsoles;
-    m_consoles=new QTextEdit*[nbConsoles];
-    for(unsigned int i=0;i<nbConsoles;i++) {
-        m_consoles[i]=new QTextEdit(this);
-        m_consoles[i]->setMinimumWidth(200);
-    }
-    m_docks=new QDockWidget*[nbConsoles];
-    for(unsigned int i=0;i<nbConsoles;i++) {
-        m_docks[i]=new QDockWidget(this);
-        m_docks[i]->setWidget(m_consoles[i]);
-    }
-    for(unsigned int i=0;i<nbConsoles/2;i++) {
-        this->addDockWidget(Qt::LeftDockWidgetArea,m_docks[i]);
-    }
-    for(unsigned int i=nbConsoles/2;i<nbConsoles;i++) {
-        this->addDockWidget(Qt::RightDockWidgetArea,m_docks[i]);
-    }
+    // Un seul journal pour toutes les sources, filtrable et virtualisé
+    m_logPanel=new LogPanel(nbConsoles,this);
+    m_logDock=new QDockWidget("Journal",this);
+    m_logDock->setWidget(m_logPanel);
+    this->addDockWidget(Qt::LeftDockWidgetArea,m_logDock);
 
-    for(unsigned int i=0;i<nbConsoles;i++)
-        setConsoleTitle(i,QString("Console number : %1").arg(i));
-    m_display=new BikeDisplay(nbSite,this);
+    m_display=new BikeDisplay(nbSite,globalSiteMap,this);
     setCentralWidget(m_display);
 
+    // Occupation des sites au fil du temps, échantillonnée sur les stations
+    m_occupancy=new OccupancyDashboard(nbSite,this);
+    m_occupancyDock=new QDockWidget("Occupation",this);
+    m_occupancyDock->setWidget(m_occupancy);
+    this->addDockWidget(Qt::RightDockWidgetArea,m_occupancyDock);
+
     QToolBar* toolbar = addToolBar("Controls");
 
     QAction* stopAction = toolbar->addAction("Stop simulation");
@@ -54,13 +58,21 @@ MainWindow::MainWindow(unsigned int nbConsoles,unsigned int nbSite,
     connect(closeAction, &QAction::triggered,
             this, &MainWindow::onEndClicked);
 
-    QAction* plusDepot = toolbar->addAction("+1 depot");
-    connect(plusDepot, &QAction::triggered,
+    m_plusDepot = toolbar->addAction("+1 depot");
+    connect(m_plusDepot, &QAction::triggered,
             this, &MainWindow::onDepotPlusClicked);
 
-    QAction* minusDepot = toolbar->addAction("-1 depot");
-    connect(minusDepot, &QAction::triggered,
+    m_minusDepot = toolbar->addAction("-1 depot");
+    connect(m_minusDepot, &QAction::triggered,
             this, &MainWindow::onDepotMinusClicked);
+
+    m_checkpointAction = toolbar->addAction("Checkpoint");
+    connect(m_checkpointAction, &QAction::triggered,
+            this, &MainWindow::onCheckpointClicked);
+
+    QAction* latencyAction = toolbar->addAction("Latency");
+    connect(latencyAction, &QAction::triggered,
+            this, &MainWindow::onLatencyClicked);
 }
 
 void MainWindow::onEndClicked()
@@ -79,6 +91,57 @@ void MainWindow::onStopClicked()
     }
 }
 
+void MainWindow::onCheckpointClicked()
+{
+    // La sauvegarde attend que les agents soient au repos : elle tourne dans son propre thread
+    // pour ne pas figer l'interface. La flotte ne doit pas changer pendant ce temps, les boutons
+    // du dépôt sont donc désactivés jusqu'à la fin.
+    if (m_checkpointThread.joinable())
+        return;
+    m_checkpointAction->setEnabled(false);
+    m_plusDepot->setEnabled(false);
+    m_minusDepot->setEnabled(false);
+
+    m_checkpointThread = std::thread([this] {
+        bool ok = checkpointSimulation();
+        QMetaObject::invokeMethod(this, [this, ok] { onCheckpointDone(ok); }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::onCheckpointDone(bool ok)
+{
+    m_checkpointThread.join();
+    m_checkpointAction->setEnabled(true);
+    m_plusDepot->setEnabled(true);
+    m_minusDepot->setEnabled(true);
+
+    if (ok)
+        consoleAppendText(0, QString("Checkpoint written to %1").arg(CHECKPOINT_FILE));
+    else
+        consoleAppendText(0, QString("Checkpoint failed: agents still active after %1 ms, or file not written")
+                                 .arg(CHECKPOINT_TIMEOUT_MS));
+}
+
+void MainWindow::onLatencyClicked()
+{
+    // Fusion des tampons de tous les threads, puis affichage et export complet
+    auto table = LatencyRecorder::instance().merge();
+    QString text = QString::fromStdString(LatencyRecorder::report(*table));
+    if (LatencyRecorder::dump(LATENCY_FILE, *table))
+        text += QString("Histograms written to %1\n").arg(LATENCY_FILE);
+
+    auto* dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle("Waiting time at stations (simulated ms)");
+    auto* view = new QPlainTextEdit(text, dialog);
+    view->setReadOnly(true);
+    view->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    view->setMinimumSize(560, 420);
+    auto* layout = new QVBoxLayout(dialog);
+    layout->addWidget(view);
+    dialog->show();
+}
+
 void MainWindow::onDepotPlusClicked()
 {
     if (!globalStations) return;
@@ -86,10 +149,7 @@ void MainWindow::onDepotPlusClicked()
     BikeStation* depot = (*globalStations)[DEPOT_ID];
 
     // Create a new bike and add it to the depot
-    auto* bike = new Bike;
-    static thread_local std::mt19937_64 rng(std::random_device{}());
-    std::uniform_int_distribution<size_t> dist(0, Bike::nbBikeTypes - 1);
-    bike->bikeType = dist(rng);
+    auto* bike = createBike(c_rng.below(Bike::nbBikeTypes));
 
     depot->putBike(bike);
 
@@ -106,7 +166,7 @@ void MainWindow::onDepotMinusClicked()
     // Try to remove one bike from depot
     auto bikes = depot->getBikes(1);
     if (!bikes.empty()) {
-        delete bikes[0]; // bike is no longer in any station, we can delete it
+        destroyBike(bikes[0]); // bike is no longer in any station, we can delete it
     }
 
     // Update GUI
@@ -122,18 +182,17 @@ void MainWindow::walk(unsigned int personId,
 }
 
 
-void MainWindow::setConsoleTitle(unsigned int consoleId,QString title)
+void MainWindow::consoleAppendText(unsigned int consoleId,QString text)
 {
-    if (consoleId>=m_nbConsoles)
-        return;
-    m_docks[consoleId]->setWindowTitle(title);
+    LogRecord record;
+    record.entity=consoleId;
+    record.timeMs=TimerWheel::instance().nowMs();
+    m_logPanel->append(record,text);
 }
 
-void MainWindow::consoleAppendText(unsigned int consoleId,QString text)
+void MainWindow::appendLog(const LogRecord &record,const QString &text)
 {
-    if (consoleId>=m_nbConsoles)
-        return;
-    m_consoles[consoleId]->append(text);
+    m_logPanel->append(record,text);
 }
 
 
@@ -159,4 +218,8 @@ void MainWindow::vanTravel(unsigned int site1, unsigned int site2,
     m_display->vanTravel(site1,site2,ms);
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow()
+{
+    if (m_checkpointThread.joinable())
+        m_checkpointThread.join();
+}
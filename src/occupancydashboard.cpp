@@ -0,0 +1,145 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : occupancydashboard.cpp
+ * Tableau de bord de l'occupation des sites : échantillonnage périodique des stations, carte de
+ * chaleur et courbes des minutes de sites vides et pleins.
+ */
+
+#include "occupancydashboard.h"
+#include "config.h"
+#include "timerwheel.h"
+
+#include <QPainter>
+#include <QPainterPath>
+
+#include <algorithm>
+
+extern std::array<BikeStation*, NB_SITES_TOTAL>* globalStations;
+
+namespace {
+
+const int LABEL_WIDTH = 28;
+const int SPARKLINE_HEIGHT = 44;
+const int MARGIN = 4;
+
+// Teinte : rouge pour un site vide, vert à moitié plein, bleu pour un site plein
+QColor occupancyColor(float _occupancy)
+{
+    return QColor::fromHsvF(0.66 * std::clamp(_occupancy, 0.0f, 1.0f), 0.8, 0.9);
+}
+
+} // namespace
+
+OccupancyDashboard::OccupancyDashboard(unsigned int _nbSites, QWidget* _parent)
+    : QWidget(_parent),
+      m_nbSites(_nbSites)
+{
+    setMinimumSize(200, 160);
+    connect(&m_pollTimer, &QTimer::timeout, this, &OccupancyDashboard::poll);
+    m_pollTimer.start(OCCUPANCY_POLL_MS);
+}
+
+QSize OccupancyDashboard::sizeHint() const {
+    return QSize(LABEL_WIDTH + 3 * static_cast<int>(OCCUPANCY_COLUMNS),
+                 12 * static_cast<int>(m_nbSites) + 2 * (SPARKLINE_HEIGHT + MARGIN) + MARGIN);
+}
+
+void OccupancyDashboard::poll() {
+    // Les stations sont créées après la fenêtre principale
+    if (!globalStations)
+        return;
+
+    if (!m_history) {
+        std::vector<size_t> capacities;
+        for (unsigned int s = 0; s < m_nbSites; ++s)
+            capacities.push_back((*globalStations)[s] ? (*globalStations)[s]->nbSlots() : 0);
+        m_history = std::make_unique<OccupancyHistory>(std::move(capacities), OCCUPANCY_COLUMNS,
+                                                       OCCUPANCY_COLUMN_MS);
+    }
+
+    // Lecture sans verrou : l'échantillonnage ne bloque jamais les stations
+    m_history->sample(TimerWheel::instance().nowMs(), takeNetworkSnapshot(*globalStations));
+    if (m_history->version() != m_paintedVersion)
+        update();
+}
+
+void OccupancyDashboard::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+    if (!m_history)
+        return;
+    m_paintedVersion = m_history->version();
+
+    const QRect area = rect().adjusted(MARGIN, MARGIN, -MARGIN, -MARGIN);
+    const int sparklinesHeight = 2 * (SPARKLINE_HEIGHT + MARGIN);
+    const QRect heatmap(area.left() + LABEL_WIDTH, area.top(),
+                        area.width() - LABEL_WIDTH, area.height() - sparklinesHeight);
+
+    // Carte de chaleur : colonnes les plus récentes à droite, largeur fixe par colonne
+    const size_t nbSites = m_history->nbSites();
+    const double cellWidth = double(heatmap.width()) / m_history->maxColumns();
+    const double cellHeight = nbSites ? double(heatmap.height()) / nbSites : 0.0;
+    const size_t nbColumns = m_history->nbColumns();
+    const double firstX = heatmap.right() + 1 - nbColumns * cellWidth;
+
+    for (size_t s = 0; s < nbSites; ++s) {
+        const double y = heatmap.top() + s * cellHeight;
+        painter.setPen(palette().windowText().color());
+        painter.drawText(QRectF(area.left(), y, LABEL_WIDTH - 2, cellHeight),
+                         Qt::AlignRight | Qt::AlignVCenter, QString("S%1").arg(s));
+        for (size_t c = 0; c < nbColumns; ++c) {
+            painter.fillRect(QRectF(firstX + c * cellWidth, y, cellWidth + 0.5, cellHeight + 0.5),
+                             occupancyColor(m_history->occupancy(c, s)));
+        }
+    }
+
+    QRect sparkline(heatmap.left(), heatmap.bottom() + MARGIN, heatmap.width(), SPARKLINE_HEIGHT);
+    paintSparkline(painter, sparkline, false, QColor(200, 50, 50), "Vide");
+    sparkline.translate(0, SPARKLINE_HEIGHT + MARGIN);
+    paintSparkline(painter, sparkline, true, QColor(50, 80, 200), "Plein");
+}
+
+void OccupancyDashboard::paintSparkline(QPainter& _painter, const QRect& _area, bool _full,
+                                        const QColor& _color, const QString& _label) const {
+    _painter.setPen(palette().mid().color());
+    _painter.drawRect(_area.adjusted(0, 0, -1, -1));
+
+    const size_t nbColumns = m_history->nbColumns();
+    if (nbColumns == 0)
+        return;
+
+    auto minutes = [&](size_t _c) {
+        const OccupancyHistory::Column& column = m_history->column(_c);
+        return _full ? column.fullMinutes : column.emptyMinutes;
+    };
+
+    double maxMinutes = 0;
+    for (size_t c = 0; c < nbColumns; ++c)
+        maxMinutes = std::max(maxMinutes, minutes(c));
+
+    // Même abscisse que les colonnes de la carte de chaleur
+    const double step = double(_area.width()) / m_history->maxColumns();
+    const double firstX = _area.right() + 1 - (nbColumns - 0.5) * step;
+    QPainterPath path;
+    for (size_t c = 0; c < nbColumns; ++c) {
+        const double value = maxMinutes > 0 ? minutes(c) / maxMinutes : 0.0;
+        const QPointF point(firstX + c * step, _area.bottom() - 2 - value * (_area.height() - 4));
+        if (c == 0)
+            path.moveTo(point);
+        else
+            path.lineTo(point);
+    }
+
+    _painter.setRenderHint(QPainter::Antialiasing, true);
+    _painter.setPen(QPen(_color, 1.5));
+    _painter.drawPath(path);
+    _painter.setRenderHint(QPainter::Antialiasing, false);
+
+    _painter.setPen(palette().windowText().color());
+    _painter.drawText(_area.adjusted(4, 2, -4, -2), Qt::AlignLeft | Qt::AlignTop,
+                      QString("%1 : %2 min (max %3)").arg(_label)
+                          .arg(minutes(nbColumns - 1), 0, 'f', 1).arg(maxMinutes, 0, 'f', 1));
+}
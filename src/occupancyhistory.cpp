@@ -0,0 +1,82 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : occupancyhistory.cpp
+ * Historique sous-échantillonné de l'occupation des sites : cumul des instantanés dans la colonne
+ * courante et anneau des colonnes terminées.
+ */
+
+#include "occupancyhistory.h"
+
+#include <algorithm>
+#include <utility>
+
+OccupancyHistory::OccupancyHistory(std::vector<size_t> _capacities, size_t _nbColumns, std::uint64_t _columnMs)
+    : m_capacities(std::move(_capacities)),
+      m_columnMs(std::max<std::uint64_t>(_columnMs, 1)),
+      m_columns(std::max<size_t>(_nbColumns, 1)),
+      m_occupancy(m_columns.size() * m_capacities.size()),
+      m_occupancySum(m_capacities.size()),
+      m_lastOccupancy(m_capacities.size())
+{}
+
+void OccupancyHistory::sample(std::uint64_t _timeMs, const NetworkSnapshot& _view) {
+    if (!m_started) {
+        m_started = true;
+        m_lastMs = _timeMs;
+        m_current.startMs = _timeMs;
+    }
+
+    // Les comptes vus sont tenus depuis l'échantillon précédent
+    const double elapsedMs = (_timeMs > m_lastMs) ? static_cast<double>(_timeMs - m_lastMs) : 0.0;
+    m_lastMs = std::max(m_lastMs, _timeMs);
+
+    for (size_t s = 0; s < nbSites(); ++s) {
+        const size_t bikes = std::min(_view[s].nbBikes, m_capacities[s]);
+        const float ratio = m_capacities[s] ? static_cast<float>(bikes) / m_capacities[s] : 0.0f;
+
+        // Une borne réservée n'est plus libre : elle compte pour le site plein
+        const size_t usedDocks = std::min(_view[s].nbBikes + _view[s].nbReservedDocks, m_capacities[s]);
+
+        m_lastOccupancy[s] = ratio;
+        m_occupancySum[s] += ratio * elapsedMs;
+        if (bikes == 0)
+            m_current.emptyMinutes += elapsedMs / 60000.0;
+        if (m_capacities[s] && usedDocks == m_capacities[s])
+            m_current.fullMinutes += elapsedMs / 60000.0;
+    }
+    m_weightMs += elapsedMs;
+
+    // Colonne terminée ; après une longue pause, la suivante reste alignée sur la grille
+    if (_timeMs >= m_current.startMs + m_columnMs)
+        closeColumn(_timeMs - (_timeMs - m_current.startMs) % m_columnMs);
+}
+
+void OccupancyHistory::closeColumn(std::uint64_t _nextStartMs) {
+    size_t slot;
+    if (m_count < m_columns.size()) {
+        slot = index(m_count);
+        ++m_count;
+    }
+    else {
+        // Anneau plein : la plus ancienne colonne est remplacée
+        slot = m_first;
+        m_first = (m_first + 1) % m_columns.size();
+    }
+
+    m_columns[slot] = m_current;
+    for (size_t s = 0; s < nbSites(); ++s) {
+        // Un seul échantillon dans la colonne : pas de durée, on garde l'état vu
+        m_occupancy[slot * nbSites() + s] = (m_weightMs > 0)
+            ? static_cast<float>(m_occupancySum[s] / m_weightMs)
+            : m_lastOccupancy[s];
+    }
+    ++m_version;
+
+    m_current = Column{};
+    m_current.startMs = _nextStartMs;
+    std::fill(m_occupancySum.begin(), m_occupancySum.end(), 0.0);
+    m_weightMs = 0;
+}
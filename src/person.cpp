@@ -13,20 +13,21 @@
 
 #include "person.h"
 #include "bike.h"
-#include <random>
+#include "timerwheel.h"
+#include "simstats.h"
+#include "latencyhistogram.h"
 
-BikingInterface* Person::binkingInterface = nullptr;
+SimulationView* Person::binkingInterface = nullptr;
 std::array<BikeStation*, NB_SITES_TOTAL> Person::stations{};
+const SiteMap* Person::siteMap = nullptr;
+const DemandModel* Person::demandModel = nullptr;
 
 
 Person::Person(unsigned int _id) : id(_id), homeSite(0), currentSite(0) {
-    static thread_local std::mt19937_64 rng(std::random_device{}());
-    std::uniform_int_distribution<size_t> dist(0, Bike::nbBikeTypes - 1);
-    preferredType = dist(rng);
+    preferredType = c_rng.below(Bike::nbBikeTypes);
 
     if (binkingInterface) {
-        log(QString("Person %1, préfère type %2")
-                .arg(id).arg(preferredType));
+        log(LogMessage::PersonPrefers, id, preferredType);
     }
 }
 
@@ -34,11 +35,53 @@ void Person::setStations(const std::array<BikeStation*, NB_SITES_TOTAL>& _statio
     Person::stations = _stations;
 }
 
-void Person::setInterface(BikingInterface* _binkingInterface) {
+void Person::setSiteMap(const SiteMap* _siteMap) {
+    siteMap = _siteMap;
+}
+
+void Person::setDemandModel(const DemandModel* _demandModel) {
+    demandModel = _demandModel;
+}
+
+void Person::setInterface(SimulationView* _binkingInterface) {
     binkingInterface = _binkingInterface;
 }
 
+void Person::restore(const AgentState& _state, Bike* _bike) {
+    homeSite = _state.homeSite;
+    currentSite = _state.site;
+    preferredType = _state.preferredType;
+    restoredBike = _bike;
+    restoredRng = _state.rng;
+}
+
+const AgentState& Person::agentState(unsigned int _site, Bike* _bike) {
+    // Réutilise le même état : pas d'allocation une fois la capacité atteinte
+    AgentState& state = publishedState;
+    state.kind = AgentState::PersonAgent;
+    state.id = id;
+    state.site = _site;
+    state.homeSite = homeSite;
+    state.preferredType = preferredType;
+    state.bikes.clear();
+    if (_bike)
+        state.bikes.push_back(_bike->id);
+    state.rng = c_rng.state();
+    return state;
+}
+
 void Person::run() {
+    // Reprise : le générateur continue la séquence sauvegardée
+    if (restoredRng)
+        c_rng.setState(*restoredRng);
+
+    Checkpoint& checkpoint = Checkpoint::instance();
+    checkpointSlot = checkpoint.registerAgent(agentState(currentSite, restoredBike));
+
+    // Le vélo tenu lors de la sauvegarde est déposé avant de repartir
+    if (restoredBike)
+        depositBikeAtSite(currentSite, restoredBike);
+
     while (true) {
         // Attendre qu'un vélo disponible et le prendre
         Bike* bike = takeBikeFromSite(currentSite);
@@ -47,8 +90,8 @@ void Person::run() {
         if (bike == nullptr)
             break;
 
-        // Choisir un autre site j != i
-        unsigned int destinationSite = chooseOtherSite(currentSite);
+        // Choisir un autre site j != i, en y réservant une borne si possible
+        unsigned int destinationSite = chooseDestination();
 
         // Aller au site j avec le vélo
         bikeTo(destinationSite, bike);
@@ -56,25 +99,54 @@ void Person::run() {
         // Attendre qu'une borne du site devienne libre et libérer son vélo
         depositBikeAtSite(destinationSite, bike);
 
-        // Aller à pied à un autre site k
+        // Aller à pied à un autre site k, en y réservant un vélo si possible
         unsigned int nextSite = chooseOtherSite(currentSite);
+        bikeReservation = stations[nextSite]->reserveBike(
+                    preferredType, walkTravelTime(currentSite, nextSite) + RESERVATION_MARGIN_MS);
         walkTo(nextSite);
     }
+
+    checkpoint.finish(checkpointSlot);
 }
 
 Bike* Person::takeBikeFromSite(unsigned int _site) {
+    const unsigned int overloadedSite = _site;
+
+    for (size_t attempt = 0; ; ++attempt) {
+        // Au-delà des voisins, on attend sans contrôle d'admission : la personne finit par être servie
+        bool overloaded = false;
+        bool* admission = (attempt < SiteMap::nbNeighbours) ? &overloaded : nullptr;
 
-    Bike* bike = stations[_site]->getBike(preferredType);
+        Checkpoint::instance().leave(checkpointSlot, agentState(_site, nullptr));
+        unsigned long long requestedAt = TimerWheel::instance().nowMs();
+        Bike* bike = stations[_site]->takeReservedBike(bikeReservation, preferredType, admission);
+        bikeReservation = Reservation();
+        Checkpoint::instance().arrive(checkpointSlot, agentState(_site, bike));
 
-    // Si bike est nullptr -> Ffin simulation
-    if (bike == nullptr)
-        return nullptr;
+        // Station surchargée : on essaie le site voisin suivant
+        if (overloaded) {
+            SimStats::instance().recordOverloadedRental();
+            unsigned int next = redirectSite(overloadedSite, attempt);
+            log(LogMessage::SiteOverloaded, id, _site, next);
+            walkTo(next);
+            _site = currentSite;
+            continue;
+        }
+
+        // Si bike est nullptr -> Ffin simulation
+        if (bike == nullptr)
+            return nullptr;
 
-    // Mise à jour de l'interface graphique
-    if (binkingInterface)
-        binkingInterface->setBikes(_site, stations[_site]->nbBikes());
+        unsigned long long waitMs = TimerWheel::instance().nowMs() - requestedAt;
+        SimStats::instance().recordRental(waitMs);
+        LatencyRecorder::instance().record(LatencyRecorder::Rent, _site, bike->bikeType, waitMs);
 
-    return bike;
+        // Mise à jour de l'interface graphique
+        if (binkingInterface)
+            binkingInterface->setBikes(_site, stations[_site]->nbBikes());
+
+        return bike;
+    }
 }
 
 void Person::depositBikeAtSite(unsigned int _site, Bike* _bike) {
@@ -82,45 +154,124 @@ void Person::depositBikeAtSite(unsigned int _site, Bike* _bike) {
     if (_bike == nullptr)
         return;
 
-    // Déposer le vélo à la station
-    stations[_site]->putBike(_bike);
+    const unsigned int overloadedSite = _site;
+
+    for (size_t attempt = 0; ; ++attempt) {
+        // Au-delà des voisins, on attend sans contrôle d'admission
+        bool overloaded = false;
+        bool* admission = (attempt < SiteMap::nbNeighbours) ? &overloaded : nullptr;
+
+        // Déposer le vélo à la station
+        Checkpoint::instance().leave(checkpointSlot, agentState(_site, _bike));
+        unsigned long long requestedAt = TimerWheel::instance().nowMs();
+        stations[_site]->putReservedBike(_bike, dockReservation, admission);
+        dockReservation = Reservation();
 
-    // Mise à jour de l'interface graphique
-    if (binkingInterface)
-        binkingInterface->setBikes(_site, stations[_site]->nbBikes());
+        // Station surchargée : le vélo n'a pas été déposé, on roule jusqu'au site voisin suivant
+        if (overloaded) {
+            Checkpoint::instance().arrive(checkpointSlot, agentState(_site, _bike));
+            SimStats::instance().recordOverloadedReturn();
+            unsigned int next = redirectSite(overloadedSite, attempt);
+            log(LogMessage::SiteOverloaded, id, _site, next);
+            bikeTo(next, _bike);
+            _site = currentSite;
+            continue;
+        }
+
+        Checkpoint::instance().arrive(checkpointSlot, agentState(_site, nullptr));
+        unsigned long long waitMs = TimerWheel::instance().nowMs() - requestedAt;
+        SimStats::instance().recordReturn(waitMs);
+        LatencyRecorder::instance().record(LatencyRecorder::Dock, _site, _bike->bikeType, waitMs);
+
+        // Mise à jour de l'interface graphique
+        if (binkingInterface)
+            binkingInterface->setBikes(_site, stations[_site]->nbBikes());
+        return;
+    }
 }
 
 void Person::bikeTo(unsigned int _dest, Bike* _bike) {
-    unsigned int t = bikeTravelTime();
+    unsigned int t = bikeTravelTime(currentSite, _dest);
+    Checkpoint::instance().leave(checkpointSlot, agentState(_dest, _bike));
     if (binkingInterface) {
         binkingInterface->travel(id, currentSite, _dest, t);
     }
+    else {
+        TimerWheel::instance().sleepFor(t);
+    }
+
     currentSite = _dest;
+    Checkpoint::instance().arrive(checkpointSlot, agentState(_dest, _bike));
+
+    // Usure du vélo : le trajet compte pour sa révision. Après arrive() : une sauvegarde lit
+    // l'usure pendant que les agents absents ou retenus ne la modifient pas
+    if (_bike)
+        _bike->recordRide(t);
 }
 
 void Person::walkTo(unsigned int _dest) {
-    unsigned int t = walkTravelTime();
+    unsigned int t = walkTravelTime(currentSite, _dest);
+    Checkpoint::instance().leave(checkpointSlot, agentState(_dest, nullptr));
     if (binkingInterface) {
         binkingInterface->walk(id, currentSite, _dest, t);
     }
+    else {
+        TimerWheel::instance().sleepFor(t);
+    }
     currentSite = _dest;
+    Checkpoint::instance().arrive(checkpointSlot, agentState(_dest, nullptr));
 }
 
 unsigned int Person::chooseOtherSite(unsigned int _from) const {
-    return randomSiteExcept(NBSITES, _from);
+    // Demande origine-destination de la période en cours
+    if (demandModel)
+        return demandModel->sample(_from, demandModel->currentProfile());
+
+    if (!siteMap)
+        return randomSiteExcept(NBSITES, _from);
+
+    // Destination tirée parmi les plus proches voisins du site de départ
+    const auto& neighbours = siteMap->nearest(_from);
+    return neighbours[c_rng.below(neighbours.size())];
+}
+
+unsigned int Person::chooseDestination() {
+    unsigned int destination = chooseOtherSite(currentSite);
+
+    for (size_t attempt = 0; attempt < RESERVATION_ATTEMPTS; ++attempt) {
+        unsigned int candidate = (attempt == 0) ? destination : chooseOtherSite(currentSite);
+        unsigned int ttl = bikeTravelTime(currentSite, candidate) + RESERVATION_MARGIN_MS;
+
+        dockReservation = stations[candidate]->reserveDock(ttl);
+        if (dockReservation.valid())
+            return candidate;
+    }
+
+    // Aucune borne libre : on part sans réservation
+    return destination;
+}
+
+unsigned int Person::redirectSite(unsigned int _site, size_t _attempt) const {
+    if (!siteMap)
+        return randomSiteExcept(NBSITES, _site);
+
+    // Le plus proche d'abord, puis les suivants s'ils sont eux aussi surchargés
+    return siteMap->nearest(_site)[_attempt % SiteMap::nbNeighbours];
 }
 
-unsigned int Person::bikeTravelTime() const {
-    return randomTravelTimeMs() + 1000;
+unsigned int Person::bikeTravelTime(unsigned int _from, unsigned int _to) const {
+    unsigned int t = siteMap ? siteMap->travelTimeMs(_from, _to) : randomTravelTimeMs();
+    return t + 1000;
 }
 
-unsigned int Person::walkTravelTime() const {
-    return randomTravelTimeMs() + 2000;
+unsigned int Person::walkTravelTime(unsigned int _from, unsigned int _to) const {
+    unsigned int t = siteMap ? siteMap->travelTimeMs(_from, _to) : randomTravelTimeMs();
+    return t + 2000;
 }
 
-void Person::log(const QString& msg) const {
+void Person::log(LogMessage _message, long long _arg0, long long _arg1, long long _arg2) const {
     if (binkingInterface) {
-        binkingInterface->consoleAppendText(id, msg);
+        binkingInterface->log(id, _message, _arg0, _arg1, _arg2);
     }
 }
 
@@ -0,0 +1,27 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : shutdown.cpp
+ * Arrêt de la simulation : demandes d'arrêt, puis réveil des stations et de la roue temporelle.
+ */
+
+#include "shutdown.h"
+#include "timerwheel.h"
+
+void requestShutdown(std::vector<std::unique_ptr<PcoThread>>& _threads,
+                     const std::array<BikeStation*, NB_SITES_TOTAL>& _stations) {
+    // Demander l'arrêt à tous les threads avant de les réveiller, pour qu'ils le voient au réveil
+    for (auto& thread : _threads)
+        if (thread)
+            thread->requestStop();
+
+    // Signaler l'arrêt à toutes les BikeStations pour réveiller tous les threads bloqués
+    for (BikeStation* station : _stations)
+        if (station)
+            station->ending();
+
+    // Arrêter la roue temporelle (réveille aussi les threads en trajet ou en pause)
+    TimerWheel::instance().stop();
+}
@@ -0,0 +1,90 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : simstats.cpp
+ * Compteurs agrégés d'une simulation : attentes des personnes aux stations (location et dépôt),
+ * demandes non servies immédiatement ou refusées (station surchargée), profondeur des files
+ * d'attente des sites et activité du van.
+ */
+
+#include "simstats.h"
+#include "config.h"
+
+SimStats& SimStats::instance() {
+    static SimStats stats;
+    return stats;
+}
+
+void SimStats::raiseMax(std::atomic<unsigned long long>& _max, unsigned long long _value) {
+    unsigned long long current = _max.load(std::memory_order_relaxed);
+    while (_value > current && !_max.compare_exchange_weak(current, _value, std::memory_order_relaxed)) {
+    }
+}
+
+void SimStats::recordRental(unsigned long long _waitMs) {
+    rentals.fetch_add(1, std::memory_order_relaxed);
+    rentWaitMs.fetch_add(_waitMs, std::memory_order_relaxed);
+    raiseMax(rentWaitMaxMs, _waitMs);
+    if (_waitMs >= TIMER_TICK_MS)
+        unservedRentals.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SimStats::recordReturn(unsigned long long _waitMs) {
+    returns.fetch_add(1, std::memory_order_relaxed);
+    returnWaitMs.fetch_add(_waitMs, std::memory_order_relaxed);
+    raiseMax(returnWaitMaxMs, _waitMs);
+    if (_waitMs >= TIMER_TICK_MS)
+        unservedReturns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SimStats::recordOverloadedRental() {
+    overloadedRentals.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SimStats::recordOverloadedReturn() {
+    overloadedReturns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SimStats::recordQueueDepth(const StationCounts& _counts) {
+    unsigned long long riders = 0;
+    for (size_t waiting : _counts.nbWaitingRiders)
+        riders += waiting;
+
+    queueSamples.fetch_add(1, std::memory_order_relaxed);
+    waitingRidersSum.fetch_add(riders, std::memory_order_relaxed);
+    raiseMax(waitingRidersMax, riders);
+    waitingDepositorsSum.fetch_add(_counts.nbWaitingDepositors, std::memory_order_relaxed);
+    raiseMax(waitingDepositorsMax, _counts.nbWaitingDepositors);
+}
+
+void SimStats::recordVanTour(unsigned long long _busyMs, unsigned long long _idleMs,
+                             unsigned long long _bikesMoved) {
+    vanBusyMs.fetch_add(_busyMs, std::memory_order_relaxed);
+    vanIdleMs.fetch_add(_idleMs, std::memory_order_relaxed);
+    vanBikesMoved.fetch_add(_bikesMoved, std::memory_order_relaxed);
+}
+
+SimStats::Summary SimStats::summary() const {
+    Summary s;
+    s.rentals = rentals.load(std::memory_order_relaxed);
+    s.rentWaitMs = rentWaitMs.load(std::memory_order_relaxed);
+    s.rentWaitMaxMs = rentWaitMaxMs.load(std::memory_order_relaxed);
+    s.unservedRentals = unservedRentals.load(std::memory_order_relaxed);
+    s.returns = returns.load(std::memory_order_relaxed);
+    s.returnWaitMs = returnWaitMs.load(std::memory_order_relaxed);
+    s.returnWaitMaxMs = returnWaitMaxMs.load(std::memory_order_relaxed);
+    s.unservedReturns = unservedReturns.load(std::memory_order_relaxed);
+    s.overloadedRentals = overloadedRentals.load(std::memory_order_relaxed);
+    s.overloadedReturns = overloadedReturns.load(std::memory_order_relaxed);
+    s.queueSamples = queueSamples.load(std::memory_order_relaxed);
+    s.waitingRidersSum = waitingRidersSum.load(std::memory_order_relaxed);
+    s.waitingRidersMax = waitingRidersMax.load(std::memory_order_relaxed);
+    s.waitingDepositorsSum = waitingDepositorsSum.load(std::memory_order_relaxed);
+    s.waitingDepositorsMax = waitingDepositorsMax.load(std::memory_order_relaxed);
+    s.vanBusyMs = vanBusyMs.load(std::memory_order_relaxed);
+    s.vanIdleMs = vanIdleMs.load(std::memory_order_relaxed);
+    s.vanBikesMoved = vanBikesMoved.load(std::memory_order_relaxed);
+    return s;
+}
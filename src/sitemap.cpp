@@ -0,0 +1,93 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : sitemap.cpp
+ * Cette classe représente la géographie du réseau : coordonnées des sites et du dépôt,
+ * chargées depuis un fichier ou disposées en cercle par défaut.
+ * Elle précalcule une matrice des distances et des temps de trajet (stockage contigu)
+ * ainsi que la liste des plus proches voisins de chaque site.
+ */
+
+#include "sitemap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+// Disposition par défaut, identique à celle de l'affichage
+const double DEFAULT_RADIUS = 250.0;
+}
+
+SiteMap::SiteMap() {
+    const double pi = std::acos(-1.0);
+    for (size_t s = 0; s < NBSITES; ++s) {
+        double angle = 2.0 * pi / static_cast<double>(NBSITES) * static_cast<double>(s);
+        xs[s] = DEFAULT_RADIUS + DEFAULT_RADIUS * std::cos(angle);
+        ys[s] = DEFAULT_RADIUS + DEFAULT_RADIUS * std::sin(angle);
+    }
+    xs[DEPOT_ID] = DEFAULT_RADIUS;
+    ys[DEPOT_ID] = DEFAULT_RADIUS;
+
+    computeMatrices();
+}
+
+bool SiteMap::loadFromFile(const std::string& _path) {
+    std::ifstream file(_path);
+    if (!file)
+        return false;
+
+    std::array<double, NB_SITES_TOTAL> newXs{};
+    std::array<double, NB_SITES_TOTAL> newYs{};
+    size_t count = 0;
+
+    std::string line;
+    while (count < NB_SITES_TOTAL && std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream in(line);
+        if (!(in >> newXs[count] >> newYs[count]))
+            return false;
+        ++count;
+    }
+
+    // Il faut une position pour chaque site et pour le dépôt
+    if (count < NB_SITES_TOTAL)
+        return false;
+
+    xs = newXs;
+    ys = newYs;
+    computeMatrices();
+    return true;
+}
+
+void SiteMap::computeMatrices() {
+    for (size_t from = 0; from < NB_SITES_TOTAL; ++from) {
+        for (size_t to = 0; to < NB_SITES_TOTAL; ++to) {
+            double d = std::hypot(xs[to] - xs[from], ys[to] - ys[from]);
+            distances[from * NB_SITES_TOTAL + to] = static_cast<float>(d);
+            travelTimes[from * NB_SITES_TOTAL + to] =
+                    TRAVEL_BASE_MS + static_cast<unsigned int>(d * TRAVEL_MS_PER_UNIT);
+        }
+    }
+
+    // Voisins triés par distance croissante, le site lui-même exclu
+    for (unsigned int s = 0; s < NBSITES; ++s) {
+        std::array<unsigned int, NBSITES - 1> others{};
+        size_t n = 0;
+        for (unsigned int o = 0; o < NBSITES; ++o) {
+            if (o != s)
+                others[n++] = o;
+        }
+
+        std::partial_sort(others.begin(), others.begin() + nbNeighbours, others.end(),
+                          [this, s](unsigned int a, unsigned int b) {
+                              return distance(s, a) < distance(s, b);
+                          });
+        std::copy_n(others.begin(), nbNeighbours, neighbours[s].begin());
+    }
+}
@@ -0,0 +1,221 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : stationlog.cpp
+ * Journal des mutations d'une station : ajout sans verrou dans l'anneau, compaction en un état
+ * courant avec intégrales d'utilisation, instantanés et reconstruction d'états passés.
+ */
+
+#include "stationlog.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+#include "timerwheel.h"
+
+namespace {
+
+const unsigned int TIME_SHIFT = 24;
+const unsigned int KIND_SHIFT = 20;
+const unsigned int COUNTER_SHIFT = 16;
+const std::uint64_t TIME_MASK = (std::uint64_t(1) << 40) - 1;
+
+} // namespace
+
+static_assert(StationLog::nbCounters <= 16, "counter index must fit in 4 bits");
+
+long StationLog::State::nbBikes() const {
+    long total = 0;
+    for (long count : counts)
+        total += count;
+    return total;
+}
+
+StationLog::StationLog(size_t _capacity, size_t _nbEvents, size_t _nbSnapshots)
+    : capacity(static_cast<long>(_capacity)) {
+    size_t size = 4;
+    while (size < _nbEvents)
+        size <<= 1;
+
+    ring = std::make_unique<Slot[]>(size);
+    mask = size - 1;
+    snapshots.reserve(std::max<size_t>(_nbSnapshots, 1));
+}
+
+std::uint64_t StationLog::encode(std::uint64_t _timeMs, Kind _kind, unsigned int _counter, int _delta) {
+    return ((_timeMs & TIME_MASK) << TIME_SHIFT)
+         | (std::uint64_t(_kind & 0xF) << KIND_SHIFT)
+         | (std::uint64_t(_counter & 0xF) << COUNTER_SHIFT)
+         | static_cast<std::uint16_t>(static_cast<std::int16_t>(_delta));
+}
+
+StationLog::Event StationLog::decode(std::uint64_t _payload) {
+    Event event;
+    event.timeMs = _payload >> TIME_SHIFT;
+    event.kind = static_cast<Kind>((_payload >> KIND_SHIFT) & 0xF);
+    event.counter = (_payload >> COUNTER_SHIFT) & 0xF;
+    event.delta = static_cast<std::int16_t>(_payload & 0xFFFF);
+    return event;
+}
+
+void StationLog::append(Kind _kind, unsigned int _counter, long _delta) {
+    // Variation sur 16 bits : une opération groupée plus grande est découpée
+    while (_delta != 0) {
+        int part = static_cast<int>(std::clamp<long>(_delta, INT16_MIN, INT16_MAX));
+        _delta -= part;
+
+        std::uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+
+        // Anneau plein d'événements non compactés : compacter avant d'écraser
+        while (index - folded.load(std::memory_order_acquire) > mask) {
+            tryCompact();
+            std::this_thread::yield();
+        }
+
+        // Date lue après la réservation de la case : l'ordre des dates suit celui du journal,
+        // sauf si le thread est suspendu entre les deux
+        const std::uint64_t now = TimerWheel::instance().nowMs();
+
+        // Écriture en release : un lecteur qui voit le nouveau contenu voit aussi la séquence impaire
+        Slot& slot = ring[index & mask];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        slot.payload.store(encode(now, _kind, _counter, part), std::memory_order_release);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+        // Compaction tous les quarts d'anneau, par le thread qui le termine
+        if ((index & (mask >> 2)) == (mask >> 2))
+            tryCompact();
+    }
+}
+
+bool StationLog::read(std::uint64_t _index, Event& _event) const {
+    const Slot& slot = ring[_index & mask];
+    std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != 2 * _index + 2)
+        return false;
+
+    // Lecture en acquire : la seconde lecture de la séquence ne peut pas la précéder
+    std::uint64_t payload = slot.payload.load(std::memory_order_acquire);
+    // Case réécrite pendant la lecture : l'événement est perdu
+    if (slot.sequence.load(std::memory_order_relaxed) != before)
+        return false;
+
+    _event = decode(payload);
+    return true;
+}
+
+void StationLog::tryCompact() {
+    if (mutex.trylock()) {
+        compactLocked();
+        mutex.unlock();
+    }
+}
+
+void StationLog::compact() {
+    mutex.lock();
+    compactLocked();
+    mutex.unlock();
+}
+
+void StationLog::compactLocked() {
+    std::uint64_t index = folded.load(std::memory_order_relaxed);
+    const std::uint64_t end = head.load(std::memory_order_acquire);
+
+    // On s'arrête au premier événement encore en cours d'écriture
+    Event event;
+    while (index < end && read(index, event)) {
+        if (!started) {
+            started = true;
+            integrals.sinceMs = integrals.untilMs = event.timeMs;
+        }
+        integrateTo(event.timeMs);
+        counts[event.counter] += event.delta;
+        ++index;
+    }
+
+    if (index == folded.load(std::memory_order_relaxed))
+        return;
+    folded.store(index, std::memory_order_release);
+
+    // Instantané de l'état compacté, le plus ancien est remplacé
+    Snapshot snapshot{index, integrals.untilMs, counts};
+    if (snapshots.size() < snapshots.capacity())
+        snapshots.push_back(snapshot);
+    else
+        snapshots[nextSnapshot] = snapshot;
+    nextSnapshot = (nextSnapshot + 1) % snapshots.capacity();
+}
+
+void StationLog::integrateTo(std::uint64_t _timeMs) {
+    // Date lue avant celle de l'événement précédent : il compte à partir de cette dernière
+    if (_timeMs <= integrals.untilMs)
+        return;
+
+    // Chaque dépôt est journalisé avant le retrait du même vélo, et chaque retrait avant le dépôt
+    // dans la borne libérée : tout préfixe du journal est un état possible de la station
+    std::uint64_t elapsed = _timeMs - integrals.untilMs;
+    long bikes = 0;
+    for (long count : counts)
+        bikes += count;
+
+    integrals.bikeMs += static_cast<std::uint64_t>(bikes) * elapsed;
+    integrals.emptyDockMs += static_cast<std::uint64_t>(capacity - bikes) * elapsed;
+    integrals.untilMs = _timeMs;
+}
+
+StationLog::Utilisation StationLog::utilisation() {
+    mutex.lock();
+    compactLocked();
+    if (started)
+        integrateTo(TimerWheel::instance().nowMs());
+    Utilisation result = integrals;
+    mutex.unlock();
+    return result;
+}
+
+StationLog::State StationLog::stateAt(std::uint64_t _timeMs) {
+    State state;
+    state.timeMs = _timeMs;
+
+    mutex.lock();
+    compactLocked();
+
+    // Instantané le plus récent qui ne dépasse pas la date demandée (sinon le début du journal)
+    const Snapshot* base = nullptr;
+    for (const Snapshot& snapshot : snapshots)
+        if (snapshot.timeMs <= _timeMs && (!base || snapshot.index > base->index))
+            base = &snapshot;
+
+    // Date antérieure à tous les instantanés et début du journal écrasé : le plus ancien est le plus proche
+    Event event;
+    if (!base && !snapshots.empty() && !read(0, event)) {
+        base = &*std::min_element(snapshots.begin(), snapshots.end(),
+                                  [](const Snapshot& _a, const Snapshot& _b) { return _a.index < _b.index; });
+        state.counts = base->counts;
+        state.exact = false;
+        mutex.unlock();
+        return state;
+    }
+
+    std::uint64_t index = base ? base->index : 0;
+    if (base)
+        state.counts = base->counts;
+
+    // Rejouer les événements suivants jusqu'à la date demandée
+    const std::uint64_t end = folded.load(std::memory_order_relaxed);
+    for (; index < end; ++index) {
+        if (!read(index, event)) {
+            state.exact = false;
+            break;
+        }
+        if (event.timeMs > _timeMs)
+            break;
+        state.counts[event.counter] += event.delta;
+    }
+
+    mutex.unlock();
+    return state;
+}
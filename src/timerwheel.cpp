@@ -0,0 +1,263 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : timerwheel.cpp
+ * Roue temporelle hiérarchique partagée par la simulation. Elle porte l'horloge simulée
+ * (temps réel ou accéléré) et planifie tous les réveils : trajets des personnes, pauses du van
+ * et expiration des réservations des stations. Un thread dédié avance la roue d'un cran à chaque tick.
+ */
+
+#include "timerwheel.h"
+
+#include <pcosynchro/pcothread.h>
+
+TimerWheel& TimerWheel::instance() {
+    static TimerWheel wheel;
+    return wheel;
+}
+
+TimerWheel::TimerWheel() : start(std::chrono::steady_clock::now()) {
+    // Une sentinelle par slot : chaque slot est une liste circulaire vide
+    nodes.resize(nbLevels * nbSlots);
+    for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].prev = i;
+        nodes[i].next = i;
+        nodes[i].linked = false;
+    }
+}
+
+unsigned long long TimerWheel::nowMs() const {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return startMs + static_cast<unsigned long long>(elapsed.count() * timeScale);
+}
+
+void TimerWheel::setStartTime(unsigned long long _simMs) {
+    mutex.lock();
+    startMs = _simMs;
+    baseTick = _simMs / TIMER_TICK_MS;
+    mutex.unlock();
+}
+
+void TimerWheel::setTimeScale(double _scale) {
+    mutex.lock();
+    timeScale = _scale;
+    start = std::chrono::steady_clock::now();
+    mutex.unlock();
+}
+
+unsigned int TimerWheel::toRealMs(unsigned int _simMs) const {
+    return static_cast<unsigned int>(_simMs / timeScale);
+}
+
+unsigned long long TimerWheel::currentTick() const {
+    return nowMs() / TIMER_TICK_MS;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(unsigned int _delayMs, Handler _handler, void* _context,
+                                         unsigned long long _arg) {
+    mutex.lock();
+
+    if (stopped) {
+        mutex.unlock();
+        return 0;
+    }
+
+    std::uint32_t index = allocate();
+    Node& node = nodes[index];
+    node.expiryTick = currentTick() + (_delayMs + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+    node.handler = _handler;
+    node.context = _context;
+    node.arg = _arg;
+    link(index);
+
+    TimerId id = (static_cast<TimerId>(node.generation) << 32) | index;
+    mutex.unlock();
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId _id) {
+    std::uint32_t index = static_cast<std::uint32_t>(_id);
+    std::uint32_t generation = static_cast<std::uint32_t>(_id >> 32);
+
+    mutex.lock();
+
+    // La génération protège contre un noeud déjà échu puis réutilisé
+    bool pending = _id != 0 && index >= nbLevels * nbSlots && index < nodes.size()
+            && nodes[index].generation == generation && nodes[index].linked;
+    if (pending) {
+        unlink(index);
+        release(index);
+    }
+
+    mutex.unlock();
+    return pending;
+}
+
+void TimerWheel::wakeSleeper(void* _sleeper, unsigned long long) {
+    auto* sleeper = static_cast<Sleeper*>(_sleeper);
+    sleeper->mutex.lock();
+    sleeper->done = true;
+    sleeper->woken.notifyOne();
+    sleeper->mutex.unlock();
+}
+
+void TimerWheel::sleepFor(unsigned int _ms) {
+    static thread_local Sleeper sleeper;
+    sleeper.done = false;
+
+    if (schedule(_ms, &TimerWheel::wakeSleeper, &sleeper) == 0)
+        return; // Roue arrêtée
+
+    sleeper.mutex.lock();
+    while (!sleeper.done) {
+        sleeper.woken.wait(&sleeper.mutex);
+    }
+    sleeper.mutex.unlock();
+}
+
+void TimerWheel::run() {
+    std::vector<Expired> expired;
+
+    while (true) {
+        mutex.lock();
+        if (stopped) {
+            mutex.unlock();
+            break;
+        }
+
+        // Traiter tous les ticks écoulés depuis le dernier passage
+        unsigned long long now = currentTick();
+        while (baseTick <= now) {
+            unsigned int index = baseTick & (nbSlots - 1);
+
+            // Le niveau 0 fait un tour complet : descendre les minuteries des niveaux supérieurs
+            if (index == 0) {
+                for (unsigned int level = 1; level < nbLevels; ++level) {
+                    cascade(level);
+                    if (((baseTick >> (level * slotBits)) & (nbSlots - 1)) != 0)
+                        break;
+                }
+            }
+
+            collectSlot(sentinel(0, index), expired);
+            ++baseTick;
+        }
+        mutex.unlock();
+
+        // Les handlers s'exécutent sans le verrou de la roue
+        for (const Expired& e : expired)
+            e.handler(e.context, e.arg);
+        expired.clear();
+
+        PcoThread::usleep(static_cast<uint64_t>(TIMER_TICK_MS * 1000 / timeScale));
+    }
+}
+
+void TimerWheel::stop() {
+    std::vector<Expired> expired;
+
+    mutex.lock();
+    stopped = true;
+    for (unsigned int level = 0; level < nbLevels; ++level) {
+        for (unsigned int slot = 0; slot < nbSlots; ++slot) {
+            std::uint32_t head = sentinel(level, slot);
+            while (nodes[head].next != head) {
+                std::uint32_t index = nodes[head].next;
+                expired.push_back({nodes[index].handler, nodes[index].context, nodes[index].arg});
+                unlink(index);
+                release(index);
+            }
+        }
+    }
+    mutex.unlock();
+
+    // Tous les dormeurs sont réveillés, les réservations expirent
+    for (const Expired& e : expired)
+        e.handler(e.context, e.arg);
+}
+
+std::uint32_t TimerWheel::allocate() {
+    if (freeList == noNode) {
+        nodes.push_back(Node{noNode, noNode, 0, false, 0, nullptr, nullptr, 0});
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    }
+    std::uint32_t index = freeList;
+    freeList = nodes[index].next;
+    return index;
+}
+
+void TimerWheel::release(std::uint32_t _index) {
+    // Nouvelle génération : les anciens identifiants deviennent invalides
+    ++nodes[_index].generation;
+    nodes[_index].next = freeList;
+    freeList = _index;
+}
+
+void TimerWheel::link(std::uint32_t _index) {
+    Node& node = nodes[_index];
+    unsigned long long delta = node.expiryTick >= baseTick ? node.expiryTick - baseTick : 0;
+
+    // Niveau le plus grossier qui résout encore l'échéance
+    unsigned int level = 0;
+    while (level + 1 < nbLevels && delta >= (1ull << ((level + 1) * slotBits)))
+        ++level;
+
+    unsigned long long tick = node.expiryTick;
+    if (delta == 0) {
+        tick = baseTick; // Déjà échue : traitée au prochain tick
+    }
+    else if (delta >= (1ull << (nbLevels * slotBits))) {
+        tick = baseTick + (1ull << (nbLevels * slotBits)) - 1; // Trop lointaine : replanifiée plus tard
+    }
+
+    std::uint32_t head = sentinel(level, (tick >> (level * slotBits)) & (nbSlots - 1));
+    node.prev = nodes[head].prev;
+    node.next = head;
+    nodes[node.prev].next = _index;
+    nodes[head].prev = _index;
+    node.linked = true;
+}
+
+void TimerWheel::unlink(std::uint32_t _index) {
+    Node& node = nodes[_index];
+    nodes[node.prev].next = node.next;
+    nodes[node.next].prev = node.prev;
+    node.linked = false;
+}
+
+void TimerWheel::cascade(unsigned int _level) {
+    std::uint32_t head = sentinel(_level, (baseTick >> (_level * slotBits)) & (nbSlots - 1));
+
+    // Détacher la liste du slot puis réinsérer chaque minuterie à un niveau plus fin
+    std::uint32_t index = nodes[head].next;
+    nodes[head].next = head;
+    nodes[head].prev = head;
+    while (index != head) {
+        std::uint32_t next = nodes[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+void TimerWheel::collectSlot(std::uint32_t _sentinel, std::vector<Expired>& _expired) {
+    std::uint32_t index = nodes[_sentinel].next;
+    nodes[_sentinel].next = _sentinel;
+    nodes[_sentinel].prev = _sentinel;
+
+    while (index != _sentinel) {
+        std::uint32_t next = nodes[index].next;
+        Node& node = nodes[index];
+        if (node.expiryTick > baseTick) {
+            // Minuterie parquée au-delà du dernier niveau : pas encore échue
+            link(index);
+        }
+        else {
+            node.linked = false;
+            _expired.push_back({node.handler, node.context, node.arg});
+            release(index);
+        }
+        index = next;
+    }
+}
@@ -11,41 +11,95 @@
  */
 
 #include "van.h"
+#include "timerwheel.h"
+#include "simstats.h"
 
-BikingInterface* Van::binkingInterface = nullptr;
+#include <algorithm>
+
+SimulationView* Van::binkingInterface = nullptr;
 std::array<BikeStation*, NB_SITES_TOTAL> Van::stations{};
+const SiteMap* Van::siteMap = nullptr;
+size_t Van::stationTarget = BORNES - 2;
+ImbalanceIndex* Van::imbalanceIndex = nullptr;
 
 Van::Van(unsigned int _id)
     : id(_id),
       currentSite(DEPOT_ID)
 {}
 
+bool Van::restore(const AgentState& _state, std::vector<Bike*> _cargo) {
+    currentSite = _state.site;
+    cargo.clear();
+    for (Bike* b : _cargo) {
+        if (!cargo.push(b))
+            return false;
+    }
+    restoredRng = _state.rng;
+    return true;
+}
+
+const AgentState& Van::agentState(unsigned int _site) {
+    // Réutilise le même état : pas d'allocation une fois la capacité atteinte
+    AgentState& state = publishedState;
+    state.kind = AgentState::VanAgent;
+    state.id = id;
+    state.site = _site;
+    state.homeSite = DEPOT_ID;
+    state.bikes.clear();
+    cargo.forEach([&state](const Bike* _b) { state.bikes.push_back(_b->id); });
+    state.rng = c_rng.state();
+    return state;
+}
+
 void Van::run() {
-    while (true) {
-        // Vérifier si un arrêt a été demandé pour ce thread
-        if (auto* self = PcoThread::thisThread(); self && self->stopRequested()) {
-            break;
-        }
+    // Reprise : le générateur continue la séquence sauvegardée
+    if (restoredRng)
+        c_rng.setState(*restoredRng);
+
+    Checkpoint& checkpoint = Checkpoint::instance();
+    checkpointSlot = checkpoint.registerAgent(agentState(currentSite));
+
+    while (!stopping()) {
+        unsigned long long tourStart = TimerWheel::instance().nowMs();
+        bikesMoved = 0;
 
         // 1. Charger la camionnette au dépôt
         loadAtDepot();
 
-        // 2. Parcourir tous les sites pour les équilibrer
-        for (unsigned int s = 0; s < NBSITES; ++s) {
+        // 2. Parcourir les sites à équilibrer, choisis parmi les plus déséquilibrés du réseau
+        for (unsigned int s : planTour(tourCandidates())) {
+            // Un arrêt interrompt la tournée entre deux sites
+            if (stopping())
+                break;
             driveTo(s);
             balanceSite(s);
         }
+        if (stopping())
+            break;
 
         // 3. Retourner au dépôt et vider la camionnette
         returnToDepot();
 
-        // 4. Faire une pause (durée constante) via PcoThread
-        PcoThread::usleep(2'000'000); // 2 secondes
+        // 4. Faire une pause (durée constante) via la roue temporelle
+        unsigned long long pauseStart = TimerWheel::instance().nowMs();
+        checkpoint.leave(checkpointSlot, agentState(currentSite));
+        TimerWheel::instance().sleepFor(VAN_PAUSE_MS);
+        checkpoint.arrive(checkpointSlot, agentState(currentSite));
+
+        SimStats::instance().recordVanTour(pauseStart - tourStart,
+                                           TimerWheel::instance().nowMs() - pauseStart, bikesMoved);
     }
-    log("Van s'arrête proprement");
+
+    checkpoint.finish(checkpointSlot);
+    log(LogMessage::VanStopped);
+}
+
+bool Van::stopping() {
+    auto* self = PcoThread::thisThread();
+    return self && self->stopRequested();
 }
 
-void Van::setInterface(BikingInterface* _binkingInterface){
+void Van::setInterface(SimulationView* _binkingInterface){
     binkingInterface = _binkingInterface;
 }
 
@@ -53,9 +107,21 @@ void Van::setStations(const std::array<BikeStation*, NB_SITES_TOTAL>& _stations)
     stations = _stations;
 }
 
-void Van::log(const QString& msg) const {
+void Van::setSiteMap(const SiteMap* _siteMap) {
+    siteMap = _siteMap;
+}
+
+void Van::setStationTarget(size_t _target) {
+    stationTarget = _target;
+}
+
+void Van::setImbalanceIndex(ImbalanceIndex* _index) {
+    imbalanceIndex = _index;
+}
+
+void Van::log(LogMessage _message, long long _arg0) const {
     if (binkingInterface) {
-        binkingInterface->consoleAppendText(0, msg);
+        binkingInterface->log(0, _message, _arg0);
     }
 }
 
@@ -63,12 +129,71 @@ void Van::driveTo(unsigned int _dest) {
     if (currentSite == _dest)
         return;
 
-    unsigned int travelTime = randomTravelTimeMs();
+    unsigned int travelTime = siteMap ? siteMap->travelTimeMs(currentSite, _dest)
+                                      : randomTravelTimeMs();
+    Checkpoint::instance().leave(checkpointSlot, agentState(_dest));
     if (binkingInterface) {
         binkingInterface->vanTravel(currentSite, _dest, travelTime);
     }
+    else {
+        TimerWheel::instance().sleepFor(travelTime);
+    }
 
     currentSite = _dest;
+    Checkpoint::instance().arrive(checkpointSlot, agentState(_dest));
+}
+
+std::vector<unsigned int> Van::tourCandidates() const {
+    std::vector<unsigned int> candidates;
+
+    if (!imbalanceIndex) {
+        for (unsigned int s = 0; s < NBSITES; ++s)
+            candidates.push_back(s);
+        return candidates;
+    }
+
+    for (const ImbalanceIndex::Entry& entry : imbalanceIndex->mostSaturated(VAN_TOUR_CANDIDATES))
+        candidates.push_back(entry.site);
+    for (const ImbalanceIndex::Entry& entry : imbalanceIndex->mostStarved(VAN_TOUR_CANDIDATES))
+        candidates.push_back(entry.site);
+
+    // Un site à la cible peut avoir des bornes occupées par des vélos à réviser
+    for (const ImbalanceIndex::Entry& entry : imbalanceIndex->mostWorn(VAN_TOUR_CANDIDATES))
+        candidates.push_back(entry.site);
+
+    // Ordre des sites, comme une tournée sur tout le réseau ; un site peut être à la fois en
+    // surplus ou en manque et avoir des vélos à réviser
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+std::vector<unsigned int> Van::planTour(const std::vector<unsigned int>& _candidates) const {
+    const size_t target = stationTarget;
+    std::vector<unsigned int> tour;
+
+    // Nombre de vélos attendu dans la camionnette au fil de la tournée
+    size_t a = cargo.size();
+
+    for (unsigned int s : _candidates) {
+        const StationCounts counts = stations[s]->snapshot();
+        size_t Vi = counts.nbBikes;
+        size_t capacityLeft = (VAN_CAPACITY > a) ? (VAN_CAPACITY - a) : 0;
+
+        // Mêmes règles que BikeStation::rebalance : vélos à réviser, surplus, puis déficit
+        size_t worn = std::min(counts.nbForMaintenance, capacityLeft);
+        Vi -= worn;
+        capacityLeft -= worn;
+        size_t surplus = std::min((Vi > target) ? Vi - target : 0, capacityLeft);
+        size_t deficit = std::min((Vi < target) ? target - Vi : 0, a);
+
+        if (worn + surplus > 0 || deficit > 0) {
+            tour.push_back(s);
+            a = a + worn + surplus - deficit;
+        }
+    }
+
+    return tour;
 }
 
 void Van::loadAtDepot() {
@@ -92,12 +217,14 @@ void Van::loadAtDepot() {
     // Charger au plus min(2, D) vélos, sans dépasser la capacité restante
     size_t toLoad = std::min<size_t>({static_cast<size_t>(2), D, capacityLeft});
     if (toLoad > 0) {
-        std::vector<Bike*> loaded = stations[DEPOT_ID]->getBikes(toLoad);
-        for (Bike* b : loaded) {
-            if (b) {
-                cargo.push_back(b);
-            }
+        Checkpoint::instance().leave(checkpointSlot, agentState(DEPOT_ID));
+        std::array<Bike*, VanCargo::capacity> loaded;
+        size_t nbLoaded = stations[DEPOT_ID]->getBikes(std::span<Bike*>(loaded.data(), toLoad));
+        for (size_t i = 0; i < nbLoaded; ++i) {
+            cargo.push(loaded[i]);
         }
+        bikesMoved += nbLoaded;
+        Checkpoint::instance().arrive(checkpointSlot, agentState(DEPOT_ID));
     }
 
     if (binkingInterface) {
@@ -117,79 +244,16 @@ void Van::balanceSite(unsigned int _site)
         return;
     }
 
-    // a = nombre de vélos dans la camionnette
-    size_t a = cargo.size();
-
-    // Vi = nombre de vélos sur le site i
-    size_t Vi = station->nbBikes();
-
-    const size_t target = BORNES - 2; // cible par site
-
-    // 2a. Si Vi > B-2 : retirer des vélos du site vers la camionnette
-    if (Vi > target && a < VAN_CAPACITY) {
-        size_t surplus = Vi - target;
-        size_t capacityLeft = VAN_CAPACITY - a;
-        size_t c = std::min(surplus, capacityLeft);
-
-        if (c > 0) {
-            std::vector<Bike*> taken = station->getBikes(c);
-            for (Bike* b : taken) {
-                if (b) {
-                    cargo.push_back(b);
-                    ++a;
-                }
-            }
-            Vi = station->nbBikes();
-        }
-    }
-
-    // 2b. Si Vi < B-2 : déposer des vélos depuis la camionnette
-    if (Vi < target && a > 0) {
-        size_t deficit = target - Vi;
-        size_t c = std::min(deficit, a); // nombre de vélos à déposer
-
-        std::vector<Bike*> toAdd;
-        toAdd.reserve(c);
-
-        size_t cDeposited = 0;
-
-        // Priorité : remplir les types manquants
-        for (size_t t = 0; t < Bike::nbBikeTypes && cDeposited < c; ++t) {
-            if (station->countBikesOfType(t) == 0) {
-                Bike* b = takeBikeFromCargo(t);
-                if (b) {
-                    toAdd.push_back(b);
-                    ++cDeposited;
-                    --a;
-                }
-            }
-        }
-
-        // Puis, compléter avec n'importe quels vélos de la camionnette
-        while (cDeposited < c && a > 0 && !cargo.empty()) {
-            Bike* b = cargo.back();
-            cargo.pop_back();
-            toAdd.push_back(b);
-            ++cDeposited;
-            --a;
-        }
-
-        if (!toAdd.empty()) {
-            // addBikes peut éventuellement rejeter des vélos si la station est pleine
-            std::vector<Bike*> rejected = station->addBikes(std::move(toAdd));
-            // Les vélos rejetés retournent dans la camionnette
-            for (Bike* b : rejected) {
-                if (b) {
-                    cargo.push_back(b);
-                    ++a;
-                }
-            }
-        }
-    }
+    // Tout l'arrêt (vélos à réviser, surplus, déficit) en une seule section critique
+    const RebalancePlan plan{stationTarget, VAN_CAPACITY};
+    Checkpoint::instance().leave(checkpointSlot, agentState(_site));
+    StationState state = station->rebalance(plan, cargo);
+    Checkpoint::instance().arrive(checkpointSlot, agentState(_site));
+    bikesMoved += state.taken + state.dropped;
 
     // Mise à jour de la GUI pour le site et le dépôt
     if (binkingInterface) {
-        binkingInterface->setBikes(_site, stations[_site]->nbBikes());
+        binkingInterface->setBikes(_site, state.nbBikes);
         binkingInterface->setBikes(DEPOT_ID, stations[DEPOT_ID]->nbBikes());
     }
 }
@@ -203,16 +267,32 @@ void Van::returnToDepot() {
         // 3. Vider la camionnette au dépôt
         BikeStation* depot = stations[DEPOT_ID];
         if (depot) {
-            std::vector<Bike*> toAdd = std::move(cargo);
+            // Révision des vélos usés avant de les remettre en circulation ; avant leave() : une
+            // sauvegarde lit l'usure pendant que les agents absents ou retenus ne la modifient pas
+            std::array<Bike*, VanCargo::capacity> toAdd;
+            size_t nbToAdd = 0;
+            size_t serviced = 0;
+            while (Bike* b = cargo.takeForMaintenance()) {
+                b->service();
+                toAdd[nbToAdd++] = b;
+                ++serviced;
+            }
+            if (serviced > 0) {
+                log(LogMessage::VanServiced, serviced);
+            }
+
+            Checkpoint::instance().leave(checkpointSlot, agentState(DEPOT_ID));
+
+            cargo.forEach([&](Bike* _b) { toAdd[nbToAdd++] = _b; });
             cargo.clear();
 
-            std::vector<Bike*> rejected = depot->addBikes(std::move(toAdd));
+            size_t added = depot->addBikes(std::span<Bike* const>(toAdd.data(), nbToAdd));
             // Les vélos rejetés (si la capacité du dépôt est atteinte) restent dans la camionnette
-            for (Bike* b : rejected) {
-                if (b) {
-                    cargo.push_back(b);
-                }
+            for (size_t i = added; i < nbToAdd; ++i) {
+                cargo.push(toAdd[i]);
             }
+            bikesMoved += added;
+            Checkpoint::instance().arrive(checkpointSlot, agentState(DEPOT_ID));
         }
     }
 
@@ -220,16 +300,3 @@ void Van::returnToDepot() {
         binkingInterface->setBikes(DEPOT_ID, stations[DEPOT_ID]->nbBikes());
     }
 }
-
-Bike* Van::takeBikeFromCargo(size_t type) {
-    for (size_t i = 0; i < cargo.size(); ++i) {
-        if (cargo[i]->bikeType == type) {
-            Bike* bike = cargo[i];
-            cargo[i] = cargo.back();
-            cargo.pop_back();
-            return bike;
-        }
-    }
-    return nullptr;
-}
-
@@ -0,0 +1,283 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : checkpoint_test.cpp
+ * Test des sauvegardes, à lancer aussi sous ThreadSanitizer (option WITH_TSAN) : une simulation
+ * sans interface graphique tourne pendant que des sauvegardes sont prises. Chaque fichier écrit
+ * doit se relire et placer chaque vélo exactement une fois (station ou agent). Sous
+ * ThreadSanitizer, la lecture de l'usure des vélos ne doit pas croiser leur écriture par les
+ * agents. Des fichiers écrits à la main vérifient ensuite que la relecture refuse les états
+ * impossibles (type inconnu, vélo dupliqué, van trop chargé) et qu'une sauvegarde qui n'obtient
+ * pas la quiescence n'écrit rien.
+ *
+ * Usage : checkpoint_test [personnes] [sauvegardes]
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include <pcosynchro/pcothread.h>
+
+#include "bikestation.h"
+#include "checkpoint.h"
+#include "config.h"
+#include "imbalanceindex.h"
+#include "person.h"
+#include "shutdown.h"
+#include "timerwheel.h"
+#include "van.h"
+#include "vancargo.h"
+
+namespace {
+
+const size_t DEFAULT_PEOPLE = 300;
+const size_t DEFAULT_SAVES = 20;
+const size_t NB_VANS = 2;
+
+// Temps simulé entre deux sauvegardes, et accélération du temps simulé
+const unsigned int SAVE_PERIOD_SIM_MS = 1000;
+const double TEST_TIME_SCALE = 20.0;
+
+const char* const TEST_FILE = "checkpoint_test.ckpt";
+
+unsigned int failures = 0;
+
+void fail(const char* _what, long long _value, long long _expected) {
+    if (++failures <= 10)
+        std::fprintf(stderr, "FAIL: %s = %lld, expected %lld\n", _what, _value, _expected);
+}
+
+/**
+ * @brief Checks that a saved state places every bike of the fleet exactly once.
+ */
+void checkPlacement(const SimulationState& _state, size_t _nbBikes) {
+    if (_state.bikes.size() != _nbBikes)
+        fail("saved bikes", _state.bikes.size(), _nbBikes);
+
+    std::unordered_set<unsigned int> placed;
+    size_t nbPlaced = 0;
+    for (const auto& docked : _state.stations) {
+        placed.insert(docked.begin(), docked.end());
+        nbPlaced += docked.size();
+    }
+    for (const AgentState& agent : _state.agents) {
+        placed.insert(agent.bikes.begin(), agent.bikes.end());
+        nbPlaced += agent.bikes.size();
+    }
+
+    if (nbPlaced != _nbBikes)
+        fail("placed bikes", nbPlaced, _nbBikes);
+    if (placed.size() != _nbBikes)
+        fail("distinct placed bikes", placed.size(), _nbBikes);
+}
+
+/**
+ * @brief Hand-written checkpoint: a bike docked at site 0, one held by a person, one in the van.
+ */
+struct TestFile
+{
+    std::vector<unsigned int> bikeIds{0, 1, 2};
+    std::array<std::vector<unsigned int>, NB_SITES_TOTAL> stations{};
+    std::uint32_t personType = 0;
+    std::vector<unsigned int> personBikes{1};
+    std::vector<unsigned int> vanBikes{2};
+
+    TestFile() { stations[0] = {0}; }
+
+    template<typename T>
+    static void put(std::ostream& _out, T _value) {
+        _out.write(reinterpret_cast<const char*>(&_value), sizeof(T));
+    }
+
+    static void putIds(std::ostream& _out, const std::vector<unsigned int>& _ids) {
+        put<std::uint32_t>(_out, _ids.size());
+        for (unsigned int id : _ids)
+            put<std::uint32_t>(_out, id);
+    }
+
+    static void putAgent(std::ostream& _out, std::uint8_t _kind, std::uint32_t _site, std::uint32_t _type,
+                         const std::vector<unsigned int>& _bikes) {
+        put<std::uint8_t>(_out, _kind);
+        put<std::uint32_t>(_out, 1);
+        put<std::uint32_t>(_out, _site);
+        put<std::uint32_t>(_out, _site);
+        put<std::uint32_t>(_out, _type);
+        putIds(_out, _bikes);
+        for (size_t i = 0; i < FastRng::State().size(); ++i)
+            put<std::uint64_t>(_out, i + 1);
+    }
+
+    bool loads() const {
+        {
+            std::ofstream out(TEST_FILE, std::ios::binary | std::ios::trunc);
+            out.write("PCOCKPT", 8);
+            put<std::uint32_t>(out, 1);
+            put<std::uint32_t>(out, NB_SITES_TOTAL);
+            put<std::uint64_t>(out, 0);
+            put<std::uint32_t>(out, bikeIds.size());
+            for (unsigned int id : bikeIds) {
+                put<std::uint32_t>(out, id);
+                put<std::uint8_t>(out, 0);
+                put<std::uint32_t>(out, 0);
+                put<std::uint64_t>(out, 0);
+                put<std::uint32_t>(out, 0);
+                put<std::uint8_t>(out, 0);
+            }
+            for (const auto& docked : stations)
+                putIds(out, docked);
+            put<std::uint32_t>(out, 2);
+            putAgent(out, AgentState::PersonAgent, 0, personType, personBikes);
+            putAgent(out, AgentState::VanAgent, DEPOT_ID, 0, vanBikes);
+        }
+        SimulationState state;
+        return Checkpoint::load(TEST_FILE, state);
+    }
+};
+
+void testRejectedFiles() {
+    if (!TestFile().loads())
+        fail("valid hand-written checkpoint accepted", 0, 1);
+
+    TestFile unknownType;
+    unknownType.personType = Bike::nbBikeTypes;
+    if (unknownType.loads())
+        fail("unknown preferred type accepted", 1, 0);
+
+    TestFile duplicateId;
+    duplicateId.bikeIds = {0, 1, 2, 1};
+    if (duplicateId.loads())
+        fail("duplicate bike id accepted", 1, 0);
+
+    TestFile placedTwice;
+    placedTwice.stations[1] = {1};
+    if (placedTwice.loads())
+        fail("bike docked and held accepted", 1, 0);
+
+    TestFile twoBikes;
+    twoBikes.personBikes = {0, 1};
+    twoBikes.stations[0].clear();
+    if (twoBikes.loads())
+        fail("person holding two bikes accepted", 1, 0);
+
+    TestFile overloadedVan;
+    overloadedVan.bikeIds.clear();
+    overloadedVan.vanBikes.clear();
+    overloadedVan.stations[0].clear();
+    overloadedVan.personBikes.clear();
+    for (unsigned int id = 0; id <= VanCargo::capacity; ++id) {
+        overloadedVan.bikeIds.push_back(id);
+        overloadedVan.vanBikes.push_back(id);
+    }
+    if (overloadedVan.loads())
+        fail("van holding more than its capacity accepted", 1, 0);
+}
+
+void testTimeout() {
+    // Un agent qui ne rejoint jamais de point de quiescence : la sauvegarde abandonne sans écrire
+    std::array<BikeStation*, NB_SITES_TOTAL> noStations{};
+    std::remove(TEST_FILE);
+    Checkpoint::Slot* busy = Checkpoint::instance().registerAgent(AgentState{});
+    if (Checkpoint::instance().save(TEST_FILE, noStations, {}))
+        fail("checkpoint written with an active agent", 1, 0);
+    if (std::ifstream(TEST_FILE))
+        fail("file left by an abandoned checkpoint", 1, 0);
+    Checkpoint::instance().finish(busy);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t nbPeople = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : DEFAULT_PEOPLE;
+    const size_t nbSaves = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : DEFAULT_SAVES;
+
+    TimerWheel& wheel = TimerWheel::instance();
+    wheel.setTimeScale(TEST_TIME_SCALE);
+
+    // Stations de l'application ; le surplus de vélos va au dépôt
+    const size_t target = BORNES - 2;
+    std::array<BikeStation*, NB_SITES_TOTAL> stations;
+    const AdmissionLimits siteAdmission{MAX_WAITING_RIDERS, MAX_WAITING_DEPOSITORS};
+    for (size_t s = 0; s < NBSITES; ++s)
+        stations[s] = new BikeStation(BORNES, SITE_WAIT_POLICY, siteAdmission);
+    stations[DEPOT_ID] = new BikeStation(NB_BIKES, DEPOT_WAIT_POLICY);
+    ImbalanceIndex imbalanceIndex(NBSITES, static_cast<long>(target));
+    for (size_t s = 0; s < NBSITES; ++s)
+        stations[s]->trackImbalance(&imbalanceIndex, s);
+
+    std::vector<Bike> bikes(NB_BIKES);
+    std::vector<Bike*> fleet;
+    size_t next = 0;
+    for (size_t s = 0; s < NB_SITES_TOTAL; ++s) {
+        size_t count = (s == DEPOT_ID) ? NB_BIKES - next : std::min(target, NB_BIKES - next);
+        std::vector<Bike*> chunk;
+        for (size_t k = 0; k < count; ++k, ++next) {
+            bikes[next].id = next;
+            bikes[next].bikeType = next % Bike::nbBikeTypes;
+            chunk.push_back(&bikes[next]);
+            fleet.push_back(&bikes[next]);
+        }
+        stations[s]->addBikes(chunk);
+    }
+
+    Person::setStations(stations);
+    Van::setStations(stations);
+    Van::setStationTarget(target);
+    Van::setImbalanceIndex(&imbalanceIndex);
+
+    std::vector<std::unique_ptr<Person>> people;
+    std::vector<std::unique_ptr<Van>> vans;
+    std::vector<std::unique_ptr<PcoThread>> threads;
+
+    threads.emplace_back(std::make_unique<PcoThread>(&TimerWheel::run, &wheel));
+    for (size_t v = 0; v < NB_VANS; ++v) {
+        vans.push_back(std::make_unique<Van>(v));
+        threads.emplace_back(std::make_unique<PcoThread>(&Van::run, vans.back().get()));
+    }
+    for (size_t i = 1; i <= nbPeople; ++i) {
+        people.push_back(std::make_unique<Person>(i));
+        threads.emplace_back(std::make_unique<PcoThread>(&Person::run, people.back().get()));
+    }
+
+    size_t nbWritten = 0;
+    for (size_t i = 0; i < nbSaves; ++i) {
+        wheel.sleepFor(SAVE_PERIOD_SIM_MS);
+        if (!Checkpoint::instance().save(TEST_FILE, stations, fleet))
+            continue;
+        ++nbWritten;
+
+        SimulationState state;
+        if (!Checkpoint::load(TEST_FILE, state)) {
+            fail("checkpoint read back", 0, 1);
+            continue;
+        }
+        checkPlacement(state, fleet.size());
+    }
+
+    // Les agents n'attendent qu'une station ou un trajet : aucune sauvegarde ne doit échouer
+    if (nbWritten != nbSaves)
+        fail("checkpoints written", nbWritten, nbSaves);
+
+    requestShutdown(threads, stations);
+    for (auto& thread : threads)
+        thread->join();
+
+    for (BikeStation* station : stations)
+        delete station;
+
+    testRejectedFiles();
+    testTimeout();
+    std::remove(TEST_FILE);
+
+    std::printf("%zu people, %zu vans: %zu checkpoints written and read back: %s\n",
+                nbPeople, NB_VANS, nbWritten, failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
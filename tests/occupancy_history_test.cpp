@@ -0,0 +1,137 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : occupancy_history_test.cpp
+ * Test de l'historique d'occupation du tableau de bord : limites des colonnes (fermeture à la fin
+ * exacte de la durée, alignement sur la grille après une pause), pondération des échantillons
+ * (chaque compte est tenu depuis l'échantillon précédent, minutes de site vide et plein, bornes
+ * réservées comptées comme occupées) et anneau des colonnes (la plus ancienne est remplacée une
+ * fois l'anneau plein).
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "occupancyhistory.h"
+
+namespace {
+
+const std::uint64_t COLUMN_MS = 1000;
+
+// Tolérance des moyennes, calculées en float
+const double EPSILON = 1e-6;
+
+unsigned int failures = 0;
+
+void check(bool _ok, const char* _what) {
+    if (!_ok) {
+        ++failures;
+        std::fprintf(stderr, "FAIL: %s\n", _what);
+    }
+}
+
+void checkNear(double _value, double _expected, const char* _what) {
+    if (std::fabs(_value - _expected) > EPSILON) {
+        ++failures;
+        std::fprintf(stderr, "FAIL: %s = %g, expected %g\n", _what, _value, _expected);
+    }
+}
+
+/**
+ * @brief Samples a network whose first two sites hold the given number of bikes.
+ */
+void sample(OccupancyHistory& _history, std::uint64_t _timeMs, size_t _bikes0, size_t _bikes1 = 0) {
+    NetworkSnapshot view{};
+    view[0].nbBikes = _bikes0;
+    view[1].nbBikes = _bikes1;
+    _history.sample(_timeMs, view);
+}
+
+void testBoundariesAndWeighting() {
+    OccupancyHistory history({4, 4}, 8, COLUMN_MS);
+
+    // Site 0 plein 250 ms puis à moitié 750 ms, site 1 vide toute la colonne
+    sample(history, 0, 4);
+    sample(history, 250, 4);
+    check(history.nbColumns() == 0, "no column before its end");
+    sample(history, 1000, 2);
+    check(history.nbColumns() == 1, "column closed at its exact end");
+    check(history.version() == 1, "version after the first column");
+
+    check(history.column(0).startMs == 0, "start of the first column");
+    checkNear(history.occupancy(0, 0), (250 * 1.0 + 750 * 0.5) / 1000, "weighted occupancy of site 0");
+    checkNear(history.occupancy(0, 1), 0.0, "occupancy of the empty site");
+    checkNear(history.column(0).fullMinutes, 250 / 60000.0, "full minutes");
+    checkNear(history.column(0).emptyMinutes, 1000 / 60000.0, "empty minutes");
+
+    // La colonne suivante commence à 1000 et ne se ferme qu'à 2000
+    sample(history, 1999, 2, 4);
+    check(history.nbColumns() == 1, "column still open 1 ms before its end");
+    sample(history, 2000, 2, 4);
+    check(history.nbColumns() == 2, "column closed at 2000");
+    check(history.column(1).startMs == 1000, "start of the second column");
+    checkNear(history.occupancy(1, 1), 1.0, "occupancy of the full site");
+
+    // Longue pause : la colonne en cours prend toute la pause, la suivante reste sur la grille
+    sample(history, 5500, 1);
+    check(history.nbColumns() == 3, "one column closed after a pause");
+    check(history.column(2).startMs == 2000, "start of the column spanning the pause");
+    checkNear(history.occupancy(2, 0), 0.25, "occupancy held over the pause");
+    sample(history, 5999, 1);
+    check(history.nbColumns() == 3, "column after the pause still open");
+    sample(history, 6000, 1);
+    check(history.nbColumns() == 4, "column after the pause closed on the grid");
+    check(history.column(3).startMs == 5000, "start of the column after the pause");
+
+    // Un compte au-delà de la capacité reste une station pleine
+    sample(history, 7000, 9);
+    checkNear(history.occupancy(4, 0), 1.0, "occupancy clamped to the capacity");
+}
+
+void testReservedDocks() {
+    OccupancyHistory history({4, 4}, 8, COLUMN_MS);
+
+    // Site 0 : 3 vélos et 1 borne réservée (plein) ; site 1 : aucun vélo, tout réservé (vide et plein)
+    NetworkSnapshot view{};
+    view[0].nbBikes = 3;
+    view[0].nbReservedDocks = 1;
+    view[1].nbReservedDocks = 4;
+    history.sample(0, view);
+    history.sample(COLUMN_MS, view);
+
+    check(history.nbColumns() == 1, "column with reserved docks closed");
+    checkNear(history.column(0).fullMinutes, 2 * COLUMN_MS / 60000.0, "full minutes with reserved docks");
+    checkNear(history.column(0).emptyMinutes, COLUMN_MS / 60000.0, "empty minutes with reserved docks");
+    checkNear(history.occupancy(0, 0), 0.75, "reserved docks are not bikes");
+}
+
+void testRingWrapAround() {
+    OccupancyHistory history({10}, 3, COLUMN_MS);
+
+    // La colonne k est fermée par l'échantillon de (k + 1) s, qui porte k + 1 vélos
+    sample(history, 0, 0);
+    for (size_t k = 1; k <= 5; ++k)
+        sample(history, k * COLUMN_MS, k);
+
+    check(history.version() == 5, "version after five columns");
+    check(history.nbColumns() == 3, "columns retained by a full ring");
+    check(history.maxColumns() == 3, "ring size");
+    for (size_t i = 0; i < history.nbColumns(); ++i) {
+        // Les deux plus anciennes colonnes ont été remplacées
+        check(history.column(i).startMs == (i + 2) * COLUMN_MS, "start of a retained column");
+        checkNear(history.occupancy(i, 0), (i + 3) / 10.0, "occupancy of a retained column");
+    }
+}
+
+} // namespace
+
+int main() {
+    testBoundariesAndWeighting();
+    testReservedDocks();
+    testRingWrapAround();
+
+    std::printf("occupancy history: %s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : shutdown_latency_test.cpp
+ * Test de la latence d'arrêt : une simulation sans interface graphique est lancée avec beaucoup de
+ * personnes et plusieurs vans, sur des stations trop petites pour tout le monde (des personnes
+ * attendent donc à une station, d'autres roulent ou marchent). Après un moment, requestShutdown()
+ * est appelé et chaque thread doit avoir terminé dans la borne donnée. Un chien de garde fait
+ * échouer le test si un thread ne se termine jamais.
+ *
+ * Usage : shutdown_latency_test [personnes] [vans] [borne en ms]
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <pcosynchro/pcothread.h>
+
+#include "bikestation.h"
+#include "config.h"
+#include "imbalanceindex.h"
+#include "person.h"
+#include "shutdown.h"
+#include "timerwheel.h"
+#include "van.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t DEFAULT_PEOPLE = 2000;
+const size_t DEFAULT_VANS = 4;
+
+// Borne de l'arrêt, mesurée de la demande au retour du dernier join()
+const long long DEFAULT_BOUND_MS = 500;
+
+// Temps simulé avant l'arrêt, et accélération du temps simulé
+const unsigned int RUN_SIM_MS = 20'000;
+const double TEST_TIME_SCALE = 20.0;
+
+long long elapsedMs(Clock::time_point _since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _since).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t nbPeople = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : DEFAULT_PEOPLE;
+    const size_t nbVans = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : DEFAULT_VANS;
+    const long long boundMs = (argc > 3) ? std::strtoll(argv[3], nullptr, 10) : DEFAULT_BOUND_MS;
+
+    TimerWheel& wheel = TimerWheel::instance();
+    wheel.setTimeScale(TEST_TIME_SCALE);
+
+    // Stations de l'application, avec leur contrôle d'admission ; le surplus de vélos va au dépôt
+    const size_t target = BORNES - 2;
+    std::array<BikeStation*, NB_SITES_TOTAL> stations;
+    const AdmissionLimits siteAdmission{MAX_WAITING_RIDERS, MAX_WAITING_DEPOSITORS};
+    for (size_t s = 0; s < NBSITES; ++s)
+        stations[s] = new BikeStation(BORNES, SITE_WAIT_POLICY, siteAdmission);
+    stations[DEPOT_ID] = new BikeStation(NB_BIKES, DEPOT_WAIT_POLICY);
+    ImbalanceIndex imbalanceIndex(NBSITES, static_cast<long>(target));
+    for (size_t s = 0; s < NBSITES; ++s)
+        stations[s]->trackImbalance(&imbalanceIndex, s);
+
+    std::vector<Bike> bikes(NB_BIKES);
+    size_t next = 0;
+    for (size_t s = 0; s < NB_SITES_TOTAL; ++s) {
+        size_t count = (s == DEPOT_ID) ? NB_BIKES - next : std::min(target, NB_BIKES - next);
+        std::vector<Bike*> chunk;
+        for (size_t k = 0; k < count; ++k, ++next) {
+            bikes[next].id = next;
+            bikes[next].bikeType = next % Bike::nbBikeTypes;
+            chunk.push_back(&bikes[next]);
+        }
+        stations[s]->addBikes(chunk);
+    }
+
+    Person::setStations(stations);
+    Van::setStations(stations);
+    Van::setStationTarget(target);
+    Van::setImbalanceIndex(&imbalanceIndex);
+
+    std::vector<std::unique_ptr<Person>> people;
+    std::vector<std::unique_ptr<Van>> vans;
+    std::vector<std::unique_ptr<PcoThread>> threads;
+
+    threads.emplace_back(std::make_unique<PcoThread>(&TimerWheel::run, &wheel));
+    for (size_t v = 0; v < nbVans; ++v) {
+        vans.push_back(std::make_unique<Van>(v));
+        threads.emplace_back(std::make_unique<PcoThread>(&Van::run, vans.back().get()));
+    }
+    for (size_t i = 1; i <= nbPeople; ++i) {
+        people.push_back(std::make_unique<Person>(i));
+        threads.emplace_back(std::make_unique<PcoThread>(&Person::run, people.back().get()));
+    }
+
+    wheel.sleepFor(RUN_SIM_MS);
+
+    // Chien de garde : un thread qui ne se termine pas ferait bloquer join() indéfiniment
+    std::atomic<bool> joined{false};
+    std::thread watchdog([&joined, boundMs] {
+        Clock::time_point start = Clock::now();
+        while (!joined.load()) {
+            if (elapsedMs(start) > 10 * boundMs + 1000) {
+                std::fprintf(stderr, "FAIL: threads still running %lld ms after the stop request\n",
+                             elapsedMs(start));
+                std::_Exit(1);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    Clock::time_point stopRequested = Clock::now();
+    requestShutdown(threads, stations);
+
+    long long slowestMs = 0;
+    for (auto& thread : threads) {
+        thread->join();
+        slowestMs = std::max(slowestMs, elapsedMs(stopRequested));
+    }
+    joined = true;
+    watchdog.join();
+
+    std::printf("%zu people, %zu vans: all %zu threads joined %lld ms after the stop request"
+                " (bound %lld ms)\n", nbPeople, nbVans, threads.size(), slowestMs, boundMs);
+
+    for (BikeStation* station : stations)
+        delete station;
+
+    if (slowestMs > boundMs) {
+        std::fprintf(stderr, "FAIL: shutdown took longer than %lld ms\n", boundMs);
+        return 1;
+    }
+    return 0;
+}
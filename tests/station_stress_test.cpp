@@ -0,0 +1,376 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : station_stress_test.cpp
+ * Test de charge d'une BikeStation, à lancer aussi sous ThreadSanitizer (option WITH_TSAN) : des
+ * personnes louent et rendent des vélos par le chemin rapide et par le moniteur (types vides,
+ * vélos à réviser, contrôle d'admission), d'autres réservent des vélos et des bornes (honorées ou
+ * laissées expirer), un van appelle rebalance() et un thread de sauvegarde gèle la station
+ * (freeze()/thaw()) pour vérifier son contenu, pendant qu'un observateur lit sans verrou les
+ * instantanés et le journal de la station. À chaque gel puis à la fin, les vélos présents,
+ * les bornes libres et les bornes réservées doivent faire exactement la capacité, et aucun vélo ne
+ * doit être perdu ni dupliqué. Enfin, sur une station sans location, les instantanés ne doivent
+ * jamais montrer à moitié faite une réservation qui expire ou un passage du van, et une station
+ * détruite avec des réservations actives ne doit laisser derrière elle aucune minuterie.
+ *
+ * Usage : station_stress_test [durée en ms]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "bikestation.h"
+#include "config.h"
+#include "fastrng.h"
+#include "timerwheel.h"
+#include "vancargo.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const long long DEFAULT_DURATION_MS = 2000;
+
+// Moins de vélos que de bornes : un dépôt finit toujours par trouver une borne
+const size_t CAPACITY = 8;
+const size_t NB_STATION_BIKES = 7;
+
+const size_t NB_RIDERS = 6;
+const size_t NB_RESERVERS = 2;
+
+// Durée de vie des réservations (ms simulées, temps réel ici)
+const unsigned int RESERVATION_TTL_MS = 3;
+
+// Délai accordé aux threads pour se terminer après l'arrêt
+const unsigned int JOIN_TIMEOUT_S = 30;
+
+std::atomic<unsigned long long> failures{0};
+
+void fail(const char* _what, long long _value, long long _expected) {
+    if (failures.fetch_add(1) < 10)
+        std::fprintf(stderr, "FAIL: %s = %lld, expected %lld\n", _what, _value, _expected);
+}
+
+/**
+ * @brief Checks the content of a frozen station.
+ *
+ * @param _bikesExpected Total number of bikes the station must hold, or -1 if unknown.
+ */
+void checkFrozen(BikeStation& _station, long long _bikesExpected) {
+    std::vector<Bike*> docked = _station.dockedBikes();
+    StationCounts counts = _station.snapshot();
+
+    std::unordered_set<unsigned int> ids;
+    for (Bike* bike : docked)
+        ids.insert(bike->id);
+    if (ids.size() != docked.size())
+        fail("distinct docked bikes", ids.size(), docked.size());
+
+    if (counts.nbBikes != docked.size())
+        fail("snapshot nbBikes", counts.nbBikes, docked.size());
+
+    // Conservation des bornes : occupées + libres + réservées = capacité
+    size_t slots = docked.size() + _station.nbFreeSlots() + counts.nbReservedDocks;
+    if (slots != _station.nbSlots())
+        fail("bikes + free slots + reserved docks", slots, _station.nbSlots());
+
+    if (_bikesExpected >= 0 && static_cast<long long>(docked.size()) != _bikesExpected)
+        fail("bikes in the station", docked.size(), _bikesExpected);
+}
+
+/**
+ * @brief Checks that snapshot() never shows a mutation made under the mutex half done.
+ *
+ * Nobody rents or returns here. Bikes are first reserved and left to expire:
+ * every consistent view holds all the bikes of the station. Then a van takes
+ * every bike at once and puts them back: a view holds all of them or none.
+ */
+void testSnapshotConsistency(long long _durationMs) {
+    BikeStation station(CAPACITY, SITE_WAIT_POLICY);
+    std::vector<Bike> bikes(NB_STATION_BIKES);
+    std::vector<Bike*> toAdd;
+    for (size_t i = 0; i < bikes.size(); ++i) {
+        bikes[i].id = i;
+        bikes[i].bikeType = i % Bike::nbBikeTypes;
+        toAdd.push_back(&bikes[i]);
+    }
+    station.addBikes(toAdd);
+
+    std::atomic<bool> stop{false};
+    auto observe = [&](long long _ms, auto&& _check) {
+        Clock::time_point end = Clock::now() + std::chrono::milliseconds(_ms);
+        while (Clock::now() < end)
+            _check(station.snapshot());
+        stop = true;
+    };
+
+    std::vector<std::thread> reservers;
+    for (size_t r = 0; r < NB_RESERVERS; ++r) {
+        reservers.emplace_back([&, r] {
+            FastRng rng(2000 + r);
+            while (!stop.load()) {
+                station.reserveBike(rng.below(Bike::nbBikeTypes), RESERVATION_TTL_MS);
+                std::this_thread::yield();
+            }
+        });
+    }
+    observe(_durationMs / 2, [](const StationCounts& _counts) {
+        if (_counts.nbBikes != NB_STATION_BIKES)
+            fail("snapshot nbBikes during reservations", _counts.nbBikes, NB_STATION_BIKES);
+    });
+    for (std::thread& reserver : reservers)
+        reserver.join();
+
+    // Les réservations restantes expirent avant l'arrêt complet du van
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    while (station.snapshot().nbReservedBikes != 0 && Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    stop = false;
+    std::thread van([&] {
+        while (!stop.load()) {
+            std::vector<Bike*> taken = station.getBikes(NB_STATION_BIKES);
+            if (!station.addBikes(taken).empty())
+                fail("bikes rejected by the van test", 1, 0);
+        }
+    });
+    observe(_durationMs / 2, [](const StationCounts& _counts) {
+        if (_counts.nbBikes != 0 && _counts.nbBikes != NB_STATION_BIKES)
+            fail("snapshot nbBikes during van stops", _counts.nbBikes, NB_STATION_BIKES);
+    });
+    van.join();
+}
+
+/**
+ * @brief Destroys a station holding reservations before their timers fire.
+ *
+ * The timers point to the station: run under a sanitizer, a handler called
+ * after the destruction is reported as a use after free.
+ */
+void testDestroyWithReservations() {
+    std::vector<Bike> bikes(NB_STATION_BIKES);
+    for (size_t round = 0; round < 100; ++round) {
+        auto station = std::make_unique<BikeStation>(CAPACITY);
+        for (size_t i = 0; i < bikes.size(); ++i) {
+            bikes[i].id = i;
+            bikes[i].bikeType = i % Bike::nbBikeTypes;
+            station->addBikes(std::vector<Bike*>{&bikes[i]});
+        }
+        for (size_t type = 0; type < Bike::nbBikeTypes; ++type)
+            station->reserveBike(type, RESERVATION_TTL_MS);
+        station->reserveDock(RESERVATION_TTL_MS);
+
+        // Détruite avant, pendant ou après l'échéance de ses minuteries
+        std::this_thread::sleep_for(std::chrono::microseconds(round * 50));
+        station.reset();
+    }
+
+    // Laisser échoir toute minuterie qui aurait survécu à sa station
+    std::this_thread::sleep_for(std::chrono::milliseconds(10 * RESERVATION_TTL_MS));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const long long durationMs = (argc > 1) ? std::strtoll(argv[1], nullptr, 10) : DEFAULT_DURATION_MS;
+
+    // Les réservations expirent par la roue temporelle
+    TimerWheel& wheel = TimerWheel::instance();
+    std::thread wheelThread(&TimerWheel::run, &wheel);
+
+    // Attente adaptative des sites, admission limitée : tous les chemins de la station sont pris
+    BikeStation station(CAPACITY, SITE_WAIT_POLICY, AdmissionLimits{2, 2});
+    std::vector<Bike> bikes(NB_STATION_BIKES);
+    std::vector<Bike*> toAdd;
+    for (size_t i = 0; i < bikes.size(); ++i) {
+        bikes[i].id = i;
+        bikes[i].bikeType = i % Bike::nbBikeTypes;
+        toAdd.push_back(&bikes[i]);
+    }
+    station.addBikes(toAdd);
+
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> agentsDone{0};
+    std::atomic<unsigned long long> rentals{0};
+    std::atomic<unsigned long long> reservations{0};
+    std::atomic<unsigned long long> stops{0};
+    std::atomic<unsigned long long> freezes{0};
+    std::atomic<unsigned long long> observations{0};
+
+    std::vector<std::thread> agents;
+
+    // Personnes : location, court trajet, retour ; certains vélos reviennent à réviser
+    for (size_t r = 0; r < NB_RIDERS; ++r) {
+        agents.emplace_back([&, r] {
+            FastRng rng(r + 1);
+            while (!stop.load()) {
+                size_t type = rng.below(Bike::nbBikeTypes);
+                bool overloaded = false;
+                Bike* bike = (r % 2) ? station.getBike(type, &overloaded) : station.getBike(type);
+                if (!bike)
+                    continue;
+                rentals.fetch_add(1, std::memory_order_relaxed);
+
+                if (rng.below(4) == 0)
+                    std::this_thread::yield();
+                if (rng.below(16) == 0)
+                    bike->needsMaintenance = true;
+
+                // Retour refusé par le contrôle d'admission : on garde le vélo et on réessaie
+                do {
+                    overloaded = false;
+                    station.putBike(bike, (r % 2) ? &overloaded : nullptr);
+                } while (overloaded);
+            }
+            agentsDone.fetch_add(1);
+        });
+    }
+
+    // Réservations de vélos et de bornes, honorées ou laissées expirer
+    for (size_t r = 0; r < NB_RESERVERS; ++r) {
+        agents.emplace_back([&, r] {
+            FastRng rng(100 + r);
+            while (!stop.load()) {
+                size_t type = rng.below(Bike::nbBikeTypes);
+                Reservation bikeReservation = station.reserveBike(type, RESERVATION_TTL_MS);
+                if (bikeReservation.valid())
+                    reservations.fetch_add(1, std::memory_order_relaxed);
+                if (bikeReservation.valid() && rng.below(3) == 0)
+                    continue;
+
+                Bike* bike = station.takeReservedBike(bikeReservation, type);
+                if (!bike)
+                    continue;
+
+                Reservation dockReservation = station.reserveDock(RESERVATION_TTL_MS);
+                if (rng.below(3) == 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(RESERVATION_TTL_MS + 1));
+                station.putReservedBike(bike, dockReservation);
+            }
+            agentsDone.fetch_add(1);
+        });
+    }
+
+    // Van : arrêts avec une cible variable ; les vélos à réviser sont révisés dans la camionnette
+    std::thread van([&] {
+        FastRng rng(1000);
+        VanCargo cargo;
+        while (!stop.load() || agentsDone.load() < NB_RIDERS + NB_RESERVERS) {
+            station.rebalance({rng.below(CAPACITY + 1), 1 + rng.below(4)}, cargo);
+            stops.fetch_add(1, std::memory_order_relaxed);
+
+            std::vector<Bike*> serviced;
+            while (Bike* bike = cargo.takeForMaintenance())
+                serviced.push_back(bike);
+            for (Bike* bike : serviced) {
+                bike->service();
+                cargo.push(bike);
+            }
+            std::this_thread::yield();
+        }
+
+        // Tout le chargement revient à la station
+        while (!cargo.empty()) {
+            std::vector<Bike*> unload;
+            cargo.forEach([&unload](Bike* _bike) { unload.push_back(_bike); });
+            cargo.clear();
+            for (Bike* bike : station.addBikes(unload))
+                cargo.push(bike);
+            std::this_thread::yield();
+        }
+    });
+
+    // Sauvegardes : coupe cohérente de la station
+    std::thread checkpointer([&] {
+        while (!stop.load()) {
+            station.freeze();
+            checkFrozen(station, -1);
+            station.thaw();
+            freezes.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    // Lecteurs sans verrou : instantanés publiés par séquence et journal de la station
+    std::thread observer([&] {
+        while (!stop.load()) {
+            StationCounts counts = station.snapshot();
+            if (counts.nbReservedDocks > CAPACITY || counts.nbReservedBikes > CAPACITY)
+                fail("published reservations", counts.nbReservedDocks + counts.nbReservedBikes, CAPACITY);
+            station.utilisation();
+
+            // Tout préfixe du journal est un état possible : aucun compteur négatif, pas de surcharge
+            StationLog::State state = station.stateAt(wheel.nowMs());
+            if (state.exact) {
+                for (long count : state.counts)
+                    if (count < 0)
+                        fail("logged counter", count, 0);
+                if (state.nbBikes() > static_cast<long>(CAPACITY))
+                    fail("logged bikes", state.nbBikes(), CAPACITY);
+            }
+            observations.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+    stop = true;
+
+    // Chien de garde : une borne ou un vélo perdu bloquerait un thread indéfiniment
+    std::atomic<bool> joined{false};
+    std::thread watchdog([&joined] {
+        Clock::time_point deadline = Clock::now() + std::chrono::seconds(JOIN_TIMEOUT_S);
+        while (!joined.load()) {
+            if (Clock::now() > deadline) {
+                std::fprintf(stderr, "FAIL: threads still blocked %u s after the stop\n", JOIN_TIMEOUT_S);
+                std::_Exit(1);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    for (std::thread& agent : agents)
+        agent.join();
+    van.join();
+    checkpointer.join();
+    observer.join();
+    joined = true;
+    watchdog.join();
+
+    // Les réservations laissées de côté expirent par la roue temporelle
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    while (Clock::now() < deadline) {
+        StationCounts counts = station.snapshot();
+        if (counts.nbReservedBikes == 0 && counts.nbReservedDocks == 0)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    station.freeze();
+    checkFrozen(station, NB_STATION_BIKES);
+    if (station.snapshot().nbReservedDocks != 0)
+        fail("reserved docks left", station.snapshot().nbReservedDocks, 0);
+    if (station.nbBikes() + station.nbFreeSlots() != station.nbSlots())
+        fail("bikes + free slots", station.nbBikes() + station.nbFreeSlots(), station.nbSlots());
+    station.thaw();
+
+    testSnapshotConsistency(std::max(2LL, durationMs / 2));
+    testDestroyWithReservations();
+
+    wheel.stop();
+    wheelThread.join();
+
+    std::printf("%llu rentals, %llu reservations, %llu van stops, %llu freezes, %llu observations"
+                " in %lld ms: %s\n", rentals.load(), reservations.load(), stops.load(), freezes.load(),
+                observations.load(), durationMs,
+                failures.load() == 0 ? "ok" : "FAILED");
+    return failures.load() == 0 ? 0 : 1;
+}
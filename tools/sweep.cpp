@@ -0,0 +1,327 @@
+/* Lab05 - PCO
+ * Date : 09.12.2025
+ * Auteurs : Samuel Fernandez - Khelfi Amine
+ */
+
+/* Fichier : sweep.cpp
+ * Lanceur de balayages de paramètres pour le dimensionnement du réseau. Pour chaque point d'une
+ * grille (bornes par station, vélos, vans, personnes), une simulation sans interface graphique est
+ * exécutée dans un processus fils, avec les mêmes BikeStation, Person et Van que l'application.
+ * Les points sont répartis sur tous les coeurs et les résultats (attentes, demande non servie,
+ * demandes refusées pour surcharge, profondeur des files d'attente, utilisation des stations et
+ * des vans) sont écrits dans un fichier CSV.
+ *
+ * Exemple : pco_sweep --docks 4,6,8 --bikes 35,50 --vans 1,2 --duration 240000 --out sweep.csv
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <pcosynchro/pcothread.h>
+
+#include "bikestation.h"
+#include "config.h"
+#include "demandmodel.h"
+#include "person.h"
+#include "shutdown.h"
+#include "simstats.h"
+#include "sitemap.h"
+#include "timerwheel.h"
+#include "van.h"
+
+namespace {
+
+/**
+ * @brief One point of the parameter grid.
+ */
+struct SweepPoint
+{
+    size_t docks;
+    size_t bikes;
+    size_t vans;
+    size_t people;
+};
+
+/**
+ * @brief Settings shared by every point of the sweep.
+ */
+struct SweepSettings
+{
+    std::vector<size_t> docks{BORNES};
+    std::vector<size_t> bikes{NB_BIKES};
+    std::vector<size_t> vans{1};
+    std::vector<size_t> people{NBPEOPLE};
+    unsigned int durationMs = SIM_DAY_MS;
+    double timeScale = 20.0;
+    unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::string output = "sweep.csv";
+};
+
+const char* CSV_HEADER =
+        "docks,bikes,vans,people,duration_ms,"
+        "rentals,rent_wait_mean_ms,rent_wait_max_ms,unserved_rent_ratio,"
+        "returns,return_wait_mean_ms,return_wait_max_ms,unserved_return_ratio,"
+        "van_busy_ratio,van_bikes_moved,overloaded_rentals,overloaded_returns,"
+        "site_bike_minutes,site_empty_dock_minutes,"
+        "rider_queue_mean,rider_queue_max,depositor_queue_mean,depositor_queue_max";
+
+std::vector<size_t> parseList(const char* _text) {
+    std::vector<size_t> values;
+    std::stringstream ss(_text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            values.push_back(std::stoul(item));
+    return values;
+}
+
+double ratio(unsigned long long _num, unsigned long long _den) {
+    return _den ? static_cast<double>(_num) / _den : 0.0;
+}
+
+Bike* createBike(unsigned int _id, unsigned int _type) {
+    auto* bike = new Bike;
+    bike->id = _id;
+    bike->bikeType = _type;
+    return bike;
+}
+
+
+/**
+ * @brief Runs one headless simulation and formats its CSV row.
+ *
+ * Meant to run in a freshly forked process: the stations, the agents and
+ * the timer wheel of the simulation are process-wide.
+ */
+std::string runPoint(const SweepPoint& _point, const SweepSettings& _settings) {
+    TimerWheel& wheel = TimerWheel::instance();
+    wheel.setTimeScale(_settings.timeScale);
+
+    SiteMap siteMap;
+    siteMap.loadFromFile(SITES_FILE);
+    DemandModel demandModel;
+    bool hasDemand = demandModel.loadFromFile(DEMAND_FILE);
+
+    // Stations : chaque site reçoit au plus docks - 2 vélos, le reste va au dépôt
+    const size_t target = _point.docks - 2;
+    std::array<BikeStation*, NB_SITES_TOTAL> stations;
+    const AdmissionLimits siteAdmission{MAX_WAITING_RIDERS, MAX_WAITING_DEPOSITORS};
+    for (size_t s = 0; s < NBSITES; ++s)
+        stations[s] = new BikeStation(_point.docks, SITE_WAIT_POLICY, siteAdmission);
+    stations[DEPOT_ID] = new BikeStation(std::max<size_t>(_point.bikes, 1), DEPOT_WAIT_POLICY);
+    ImbalanceIndex imbalanceIndex(NBSITES, static_cast<long>(target));
+    for (size_t s = 0; s < NBSITES; ++s)
+        stations[s]->trackImbalance(&imbalanceIndex, s);
+
+    size_t created = 0;
+    for (size_t s = 0; s < NB_SITES_TOTAL; ++s) {
+        size_t count = (s == DEPOT_ID) ? _point.bikes - created
+                                       : std::min(target, _point.bikes - created);
+        std::vector<Bike*> chunk;
+        for (size_t k = 0; k < count; ++k, ++created)
+            chunk.push_back(createBike(created, created % Bike::nbBikeTypes));
+        stations[s]->addBikes(chunk);
+    }
+
+    Person::setStations(stations);
+    Van::setStations(stations);
+    Person::setSiteMap(&siteMap);
+    Van::setSiteMap(&siteMap);
+    Van::setStationTarget(target);
+    Van::setImbalanceIndex(&imbalanceIndex);
+    if (hasDemand)
+        Person::setDemandModel(&demandModel);
+
+    std::vector<std::unique_ptr<PcoThread>> threads;
+
+    threads.emplace_back(std::make_unique<PcoThread>(&TimerWheel::run, &wheel));
+    for (size_t v = 0; v < _point.vans; ++v)
+        threads.emplace_back(std::make_unique<PcoThread>(&Van::run, new Van(v)));
+    for (size_t i = 1; i <= _point.people; ++i)
+        threads.emplace_back(std::make_unique<PcoThread>(&Person::run, new Person(i)));
+
+    // La durée de la simulation s'écoule en temps simulé ; les files d'attente des sites sont
+    // échantillonnées sans verrou à intervalle régulier
+    for (unsigned int elapsed = 0; elapsed < _settings.durationMs; elapsed += QUEUE_SAMPLE_MS) {
+        wheel.sleepFor(std::min(QUEUE_SAMPLE_MS, _settings.durationMs - elapsed));
+        for (size_t s = 0; s < NBSITES; ++s)
+            SimStats::instance().recordQueueDepth(stations[s]->snapshot());
+    }
+    requestShutdown(threads, stations);
+    for (auto& thread : threads)
+        thread->join();
+
+    SimStats::Summary stats = SimStats::instance().summary();
+
+    // Intégrales d'utilisation des sites, tirées du journal de chaque station
+    double bikeMinutes = 0;
+    double emptyDockMinutes = 0;
+    for (size_t s = 0; s < NBSITES; ++s) {
+        StationLog::Utilisation utilisation = stations[s]->utilisation();
+        bikeMinutes += utilisation.bikeMinutes();
+        emptyDockMinutes += utilisation.emptyDockMinutes();
+    }
+
+    char row[512];
+    std::snprintf(row, sizeof(row), "%zu,%zu,%zu,%zu,%u,%llu,%.3f,%llu,%.4f,%llu,%.3f,%llu,%.4f,%.4f,%llu,%llu,%llu,%.1f,%.1f,"
+                                    "%.3f,%llu,%.3f,%llu\n",
+                  _point.docks, _point.bikes, _point.vans, _point.people, _settings.durationMs,
+                  stats.rentals, ratio(stats.rentWaitMs, stats.rentals), stats.rentWaitMaxMs,
+                  ratio(stats.unservedRentals, stats.rentals),
+                  stats.returns, ratio(stats.returnWaitMs, stats.returns), stats.returnWaitMaxMs,
+                  ratio(stats.unservedReturns, stats.returns),
+                  ratio(stats.vanBusyMs, stats.vanBusyMs + stats.vanIdleMs), stats.vanBikesMoved,
+                  stats.overloadedRentals, stats.overloadedReturns, bikeMinutes, emptyDockMinutes,
+                  ratio(stats.waitingRidersSum, stats.queueSamples), stats.waitingRidersMax,
+                  ratio(stats.waitingDepositorsSum, stats.queueSamples), stats.waitingDepositorsMax);
+    return row;
+}
+
+/**
+ * @brief Child process being run for one grid point.
+ */
+struct Job
+{
+    pid_t pid;
+    int fd;
+    size_t index;
+};
+
+bool parseArgs(int _argc, char* _argv[], SweepSettings& _settings) {
+    for (int i = 1; i + 1 < _argc; i += 2) {
+        const char* name = _argv[i];
+        const char* value = _argv[i + 1];
+        if (std::strcmp(name, "--docks") == 0)
+            _settings.docks = parseList(value);
+        else if (std::strcmp(name, "--bikes") == 0)
+            _settings.bikes = parseList(value);
+        else if (std::strcmp(name, "--vans") == 0)
+            _settings.vans = parseList(value);
+        else if (std::strcmp(name, "--people") == 0)
+            _settings.people = parseList(value);
+        else if (std::strcmp(name, "--duration") == 0)
+            _settings.durationMs = std::stoul(value);
+        else if (std::strcmp(name, "--scale") == 0)
+            _settings.timeScale = std::stod(value);
+        else if (std::strcmp(name, "--jobs") == 0)
+            _settings.jobs = std::max(1ul, std::stoul(value));
+        else if (std::strcmp(name, "--out") == 0)
+            _settings.output = value;
+        else
+            return false;
+    }
+    return _argc % 2 == 1 && _settings.timeScale > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    SweepSettings settings;
+    if (!parseArgs(argc, argv, settings)) {
+        std::fprintf(stderr, "usage: %s [--docks 4,6] [--bikes 35,50] [--vans 1,2] [--people 10]"
+                             " [--duration ms] [--scale x] [--jobs n] [--out file.csv]\n", argv[0]);
+        return 1;
+    }
+
+    // Grille complète (produit cartésien des listes)
+    std::vector<SweepPoint> grid;
+    for (size_t docks : settings.docks)
+        for (size_t bikes : settings.bikes)
+            for (size_t vans : settings.vans)
+                for (size_t people : settings.people) {
+                    if (docks < 4) {
+                        std::fprintf(stderr, "skipping docks=%zu: each station needs at least 4 slots\n", docks);
+                        continue;
+                    }
+                    grid.push_back({docks, bikes, vans, people});
+                }
+
+    std::vector<std::string> rows(grid.size());
+    std::vector<Job> running;
+    size_t next = 0;
+    size_t finished = 0;
+    size_t failed = 0;
+
+    while (next < grid.size() || !running.empty()) {
+        // Lancer des simulations tant qu'il reste des coeurs libres
+        while (next < grid.size() && running.size() < settings.jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                std::perror("pipe");
+                return 1;
+            }
+
+            pid_t pid = fork();
+            if (pid < 0) {
+                std::perror("fork");
+                return 1;
+            }
+            if (pid == 0) {
+                close(fds[0]);
+                std::string row = runPoint(grid[next], settings);
+                // Une ligne courte (< PIPE_BUF) : écrite d'un bloc, sans attendre le parent
+                ssize_t written = write(fds[1], row.data(), row.size());
+                _exit(written == static_cast<ssize_t>(row.size()) ? 0 : 1);
+            }
+
+            close(fds[1]);
+            running.push_back({pid, fds[0], next});
+            ++next;
+        }
+
+        // Attendre la fin d'une simulation et récupérer sa ligne
+        int status = 0;
+        pid_t done = wait(&status);
+        if (done < 0) {
+            std::perror("wait");
+            return 1;
+        }
+
+        auto job = std::find_if(running.begin(), running.end(),
+                                [done](const Job& _job) { return _job.pid == done; });
+        if (job == running.end())
+            continue;
+
+        char buffer[512];
+        ssize_t n = read(job->fd, buffer, sizeof(buffer));
+        close(job->fd);
+
+        const SweepPoint& point = grid[job->index];
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && n > 0) {
+            rows[job->index].assign(buffer, n);
+        }
+        else {
+            ++failed;
+            std::fprintf(stderr, "simulation failed for docks=%zu bikes=%zu vans=%zu people=%zu\n",
+                         point.docks, point.bikes, point.vans, point.people);
+        }
+        std::fprintf(stderr, "[%zu/%zu] docks=%zu bikes=%zu vans=%zu people=%zu\n",
+                     ++finished, grid.size(),
+                     point.docks, point.bikes, point.vans, point.people);
+        running.erase(job);
+    }
+
+    // Résultats dans l'ordre de la grille
+    FILE* out = std::fopen(settings.output.c_str(), "w");
+    if (!out) {
+        std::perror(settings.output.c_str());
+        return 1;
+    }
+    std::fprintf(out, "%s\n", CSV_HEADER);
+    for (const std::string& row : rows)
+        if (!row.empty())
+            std::fputs(row.c_str(), out);
+    std::fclose(out);
+
+    return failed == 0 ? 0 : 2;
+}